@@ -27,6 +27,11 @@
 #define Nifti2Dicom_VERSION "${Nifti2Dicom_VERSION}"
 
 #define TCLAP_VERSION "${TCLAP_VERSION}"
+
+#cmakedefine N2D_HAVE_ZSTD
+#cmakedefine N2D_HAVE_MEMFD_CREATE
+#cmakedefine N2D_HAVE_LIBURING
+#cmakedefine N2D_HAVE_SYNCFS
 #include <itkVersion.h>
 #include <gdcmVersion.h>
 
@@ -65,7 +65,14 @@ bool Acquisition::Update()
     if (!m_AcquisitionArgs.acquisitiondate.empty())
         itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiondatetag, m_AcquisitionArgs.acquisitiondate);
     else
-        itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiondatetag, tools::Date::DateStr());
+    {
+        // Kept if restored from a previous conversion
+        std::string acquisitionDate;
+        itk::ExposeMetaData<std::string>(m_Dict, acquisitiondatetag, acquisitionDate);
+        if (acquisitionDate.empty())
+            acquisitionDate = tools::Date::DateStr();
+        itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiondatetag, acquisitionDate);
+    }
 //END (0008,0022) Acquisition Date
 
 
@@ -74,7 +81,13 @@ bool Acquisition::Update()
     if (!m_AcquisitionArgs.acquisitiontime.empty())
         itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiontimetag, m_AcquisitionArgs.acquisitiontime);
     else
-        itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiontimetag, tools::Date::TimeStr());
+    {
+        std::string acquisitionTime;
+        itk::ExposeMetaData<std::string>(m_Dict, acquisitiontimetag, acquisitionTime);
+        if (acquisitionTime.empty())
+            acquisitionTime = tools::Date::TimeStr();
+        itk::EncapsulateMetaData<std::string>( m_Dict, acquisitiontimetag, acquisitionTime);
+    }
 //END (0008,0032) Acquisition Time
 
 
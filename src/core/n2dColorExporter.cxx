@@ -0,0 +1,362 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dColorExporter.h"
+#include "n2dSliceWriter.h"
+#include "n2dToolsDataSet.h"
+#include "n2dToolsPathTemplate.h"
+
+#include <gdcmAttribute.h>
+#include <gdcmByteValue.h>
+#include <gdcmUIDGenerator.h>
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cstring>
+
+
+namespace n2d {
+
+//BEGIN Default values
+const std::string secondarycapturesopclassuid           ( "1.2.840.10008.5.1.4.1.1.7" );
+const std::string multiframetruecolorsopclassuid        ( "1.2.840.10008.5.1.4.1.1.7.4" );
+const std::string defaultconversiontype                 ( "WSD" );
+//END Default values
+
+
+
+namespace {
+
+// Copies the tags with a string VR, except the file meta information and
+// the image pixel tags, set by the exporter
+void CopyDictionary( const DictionaryType& dict, gdcm::DataSet& dataSet )
+{
+    for (DictionaryType::ConstIterator itr = dict.Begin(); itr != dict.End(); ++itr)
+    {
+        const MetaDataStringType* entryvalue = dynamic_cast<const MetaDataStringType*>( itr->second.GetPointer() );
+        if (!entryvalue || itr->first.compare(0, 5, "0002|") == 0 || itr->first.compare(0, 5, "0028|") == 0)
+            continue;
+        tools::SetDictionaryEntry(dataSet, itr->first, entryvalue->GetMetaDataObjectValue());
+    }
+}
+
+
+// Image Pixel module of 8 bits RGB frames
+void SetColorPixelTags( gdcm::DataSet& dataSet, const ImageType::SizeType& size, bool planar )
+{
+    gdcm::Attribute<0x0028, 0x0002> samplesPerPixel;
+    samplesPerPixel.SetValue(3);
+    dataSet.Replace(samplesPerPixel.GetAsDataElement());
+    tools::SetString(dataSet, gdcm::Tag(0x0028, 0x0004), "RGB");                      // Photometric Interpretation
+    gdcm::Attribute<0x0028, 0x0006> planarConfiguration;
+    planarConfiguration.SetValue(planar ? 1 : 0);
+    dataSet.Replace(planarConfiguration.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0010> rows;
+    rows.SetValue(static_cast<unsigned short>(size[1]));
+    dataSet.Replace(rows.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0011> columns;
+    columns.SetValue(static_cast<unsigned short>(size[0]));
+    dataSet.Replace(columns.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0100> bitsAllocated;
+    bitsAllocated.SetValue(8);
+    dataSet.Replace(bitsAllocated.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0101> bitsStored;
+    bitsStored.SetValue(8);
+    dataSet.Replace(bitsStored.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0102> highBit;
+    highBit.SetValue(7);
+    dataSet.Replace(highBit.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0103> pixelRepresentation;
+    pixelRepresentation.SetValue(0);
+    dataSet.Replace(pixelRepresentation.GetAsDataElement());
+}
+
+
+// Image Position and Image Orientation of a slice, Pixel Spacing
+void SetGeometryTags( gdcm::DataSet& dataSet, const Color3DImageType* image, std::size_t slice )
+{
+    const ImageType::SpacingType spacing = image->GetSpacing();
+    const ImageType::DirectionType direction = image->GetDirection();
+    ImageType::IndexType index = image->GetBufferedRegion().GetIndex();
+    index[2] += slice;
+    ImageType::PointType position;
+    image->TransformIndexToPhysicalPoint(index, position);
+
+    gdcm::Attribute<0x0020, 0x0032> imagePosition;
+    gdcm::Attribute<0x0020, 0x0037> imageOrientation;
+    for (unsigned int j = 0; j < 3; j++)
+    {
+        imagePosition.SetValue(position[j], j);
+        imageOrientation.SetValue(direction[j][0], j);
+        imageOrientation.SetValue(direction[j][1], j + 3);
+    }
+    dataSet.Replace(imagePosition.GetAsDataElement());
+    dataSet.Replace(imageOrientation.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0030> pixelSpacing;
+    pixelSpacing.SetValue(spacing[1], 0);
+    pixelSpacing.SetValue(spacing[0], 1);
+    dataSet.Replace(pixelSpacing.GetAsDataElement());
+}
+
+
+// Sets a Pixel Data of \c length bytes, padded to an even length, and
+// returns its buffer, so that the frames are packed in place.
+unsigned char* SetPixelData( gdcm::DataSet& dataSet, std::size_t length )
+{
+    const std::size_t padded = length + length % 2;
+    gdcm::SmartPointer<gdcm::ByteValue> value = new gdcm::ByteValue;
+    value->SetLength(static_cast<uint32_t>(padded));
+    gdcm::DataElement element(gdcm::Tag(0x7fe0, 0x0010));
+    element.SetVR(gdcm::VR::OB);
+    element.SetValue(*value);
+    dataSet.Replace(element);
+
+    unsigned char* buffer = static_cast<unsigned char*>(value->GetVoidPointer());
+    if (padded != length)
+        buffer[length] = 0;
+    return buffer;
+}
+
+
+// Packs the \c count pixels of a frame: a copy when interleaved, otherwise
+// the three planes are filled in the same pass.
+void PackFrame( const ColorPixelType* in, std::size_t count, bool planar, unsigned char* out )
+{
+    if (!planar)
+    {
+        std::memcpy(out, in, count * sizeof(ColorPixelType));
+        return;
+    }
+    unsigned char* red = out;
+    unsigned char* green = out + count;
+    unsigned char* blue = out + 2 * count;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        red[i] = in[i][0];
+        green[i] = in[i][1];
+        blue[i] = in[i][2];
+    }
+}
+
+} // namespace
+
+
+
+bool ColorExporter::Export( void )
+{
+#ifdef DEBUG
+    std::cout << "ColorExporter - BEGIN" << std::endl;
+#endif // DEBUG
+
+    const Color3DImageType* image = dynamic_cast<const Color3DImageType*>(m_Image.GetPointer());
+    if(!image)
+    {
+        std::cerr << "Error Null Pointer In Exporter" << std::endl;
+        return false;
+    }
+    if (m_OutputArgs.incremental || m_OutputArgs.resume)
+    {
+        std::cerr << "ERROR: Color images cannot be converted incrementally or resumed" << std::endl;
+        return false;
+    }
+
+    const ImageType::RegionType region = image->GetBufferedRegion();
+    const ImageType::SizeType size = region.GetSize();
+    const std::size_t nbSlices = size[2];
+    // Numbers in the file names are those of the whole volume (see FiltersArgs::slicestart)
+    const std::size_t firstSlice = static_cast<std::size_t>(region.GetIndex()[2]);
+    const std::size_t sliceSize = static_cast<std::size_t>(size[0]) * size[1];
+    const std::size_t frameBytes = sliceSize * sizeof(ColorPixelType);
+    const bool planar = m_OutputArgs.planar;
+    const bool multiframe = (m_OutputArgs.coloriod == "multiframe");
+    const ColorPixelType* buffer = image->GetBufferPointer();
+    if (nbSlices == 0 || m_DictionaryArray.size() < nbSlices)
+    {
+        std::cerr << "ERROR: No slice to write" << std::endl;
+        return false;
+    }
+
+//BEGIN Output filename
+    // As n2d::OutputExporter, the multi-frame image is the first slice
+    const std::size_t nbFiles = multiframe ? 1 : nbSlices;
+    std::vector<std::string> names;
+    if (!m_OutputArgs.layout.empty())
+    {
+        tools::PathTemplate layout;
+        if (!layout.Parse(m_OutputArgs.layout))
+        {
+            std::cerr << "ERROR: Invalid layout: " << layout.GetError() << std::endl;
+            return false;
+        }
+        for (std::size_t i = 0; i < nbFiles; i++)
+            names.push_back(layout.Expand(*m_DictionaryArray[i], firstSlice + i + 1));
+    }
+    else
+    {
+        std::ostringstream fmt;
+        fmt << m_OutputArgs.prefix << "%0" << m_OutputArgs.digits << "d" << m_OutputArgs.suffix;
+
+        NameGeneratorType::Pointer namesGenerator = NameGeneratorType::New();
+        namesGenerator->SetStartIndex( firstSlice + 1 );
+        namesGenerator->SetEndIndex( firstSlice + nbFiles );
+        namesGenerator->SetIncrementIndex( 1 );
+        namesGenerator->SetSeriesFormat( fmt.str().c_str() );
+        names = namesGenerator->GetFileNames();
+    }
+//END Output filename
+
+    // UIDs missing from the dictionaries are shared by all the slices
+    gdcm::UIDGenerator uidGenerator;
+    const std::string studyInstanceUID = uidGenerator.Generate();
+    const std::string seriesInstanceUID = uidGenerator.Generate();
+    const std::string frameOfReferenceUID = uidGenerator.Generate();
+
+
+
+//BEGIN Writer
+    std::unique_ptr<SliceWriter> writer( SliceWriter::New(m_OutputArgs) );
+    std::cout << " * \033[1;34mWriting\033[0m... " << std::endl;
+    if (!writer->Open())
+    {
+        std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        return false;
+    }
+
+    for (std::size_t i = 0; i < nbFiles; i++)
+    {
+        gdcm::DataSet dataSet;
+        CopyDictionary(*m_DictionaryArray[i], dataSet);
+
+        //BEGIN SOP Common, General Study, General Series and SC Equipment
+        tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0016), multiframe ? multiframetruecolorsopclassuid : secondarycapturesopclassuid); // SOP Class UID
+        tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0018), uidGenerator.Generate());            // SOP Instance UID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x000d), studyInstanceUID);          // Study Instance UID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x000e), seriesInstanceUID);         // Series Instance UID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0052), frameOfReferenceUID);       // Frame of Reference UID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0010), "");                        // Patient's Name
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0020), "");                        // Patient ID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0030), "");                        // Patient's Birth Date
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0040), "");                        // Patient's Sex
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0020), "");                        // Study Date
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0030), "");                        // Study Time
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0050), "");                        // Accession Number
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0090), "");                        // Referring Physician's Name
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0010), "");                        // Study ID
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0011), "");                        // Series Number
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0020), "");                        // Patient Orientation
+        tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0064), defaultconversiontype);     // Conversion Type
+        //END SOP Common, General Study, General Series and SC Equipment
+
+        SetColorPixelTags(dataSet, size, planar);
+        SetGeometryTags(dataSet, image, i);
+
+        unsigned char* pixelData = NULL;
+        if (!multiframe)
+        {
+            pixelData = SetPixelData(dataSet, frameBytes);
+            PackFrame(buffer + i * sliceSize, sliceSize, planar, pixelData);
+        }
+        else
+        {
+            //BEGIN Multi-frame
+            // Frames are the slices, located along the normal of the slices
+            const unsigned long long pixelDataBytes = static_cast<unsigned long long>(nbSlices) * frameBytes;
+            if (pixelDataBytes >= 0xFFFFFFFEULL)
+            {
+                std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+                std::cerr << "ERROR: The multi-frame image is larger than 4 GB, write one image per slice." << std::endl;
+                return false;
+            }
+
+            tools::SetString(dataSet, gdcm::Tag(0x0020, 0x0013), "1");                            // Instance Number
+            gdcm::Attribute<0x0028, 0x0008> numberOfFrames;
+            numberOfFrames.SetValue(static_cast<int>(nbSlices));
+            dataSet.Replace(numberOfFrames.GetAsDataElement());
+            const gdcm::Tag sliceLocationVectorTag(0x0018, 0x2005);
+            gdcm::Attribute<0x0028, 0x0009> frameIncrementPointer;
+            frameIncrementPointer.SetValues(&sliceLocationVectorTag, 1, true);
+            dataSet.Replace(frameIncrementPointer.GetAsDataElement());
+
+            const ImageType::DirectionType direction = image->GetDirection();
+            std::vector<double> locations(nbSlices);
+            for (std::size_t z = 0; z < nbSlices; z++)
+            {
+                ImageType::IndexType index = region.GetIndex();
+                index[2] += z;
+                ImageType::PointType position;
+                image->TransformIndexToPhysicalPoint(index, position);
+                locations[z] = 0.0;
+                for (unsigned int j = 0; j < 3; j++)
+                    locations[z] += position[j] * direction[j][2];
+            }
+            gdcm::Attribute<0x0018, 0x2005> sliceLocationVector;
+            sliceLocationVector.SetValues(&locations[0], nbSlices, true);
+            dataSet.Replace(sliceLocationVector.GetAsDataElement());
+
+            // Each thread packs a block of frames in place
+            pixelData = SetPixelData(dataSet, static_cast<std::size_t>(pixelDataBytes));
+            std::size_t threads = std::thread::hardware_concurrency();
+            if (threads == 0)
+                threads = 1;
+            if (threads > nbSlices)
+                threads = nbSlices;
+            auto job = [&](std::size_t first, std::size_t last)
+            {
+                for (std::size_t z = first; z < last; z++)
+                    PackFrame(buffer + z * sliceSize, sliceSize, planar, pixelData + z * frameBytes);
+            };
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < threads; t++)
+                pool.push_back(std::thread(job, nbSlices * t / threads, nbSlices * (t + 1) / threads));
+            job(0, nbSlices / threads);
+            for (std::size_t t = 0; t < pool.size(); t++)
+                pool[t].join();
+            //END Multi-frame
+        }
+
+        if (!tools::WriteDataSet(dataSet, writer->GetSliceFileName(names[i])) || !writer->SliceWritten(names[i]))
+        {
+            std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+            std::cerr << "ERROR: Cannot write " << names[i] << std::endl;
+            return false;
+        }
+    }
+
+    if (!writer->Close())
+    {
+        std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: Cannot complete the output" << std::endl;
+        return false;
+    }
+    std::cout << " * \033[1;34mWriting\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+//END Writer
+
+#ifdef DEBUG
+    std::cout << "ColorExporter - END" << std::endl;
+#endif // DEBUG
+
+    return true;
+}
+
+} // namespace n2d
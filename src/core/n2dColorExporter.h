@@ -0,0 +1,75 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DCOLOREXPORTER_H
+#define N2DCOLOREXPORTER_H
+
+#include "n2dDefsCommandLineArgsStructs.h"
+#include "n2dDefsImage.h"
+#include "n2dDefsMetadata.h"
+
+namespace n2d {
+
+//BEGIN class n2d::ColorExporter
+/*!
+ * \brief Writes the filtered color image (ColorPixelType) as DICOM
+ *
+ * The pixels are 8 bits RGB, interleaved (Planar Configuration 0) or, if
+ * OutputArgs::planar is set, one plane per component (Planar Configuration
+ * 1). Each frame is packed in a single pass over its pixels, whatever the
+ * layout.
+ *
+ * OutputArgs::coloriod selects the IOD:
+ *
+ * \li "sc": one Secondary Capture Image per slice, with the tags of the
+ *     slice built by n2d::Instance and named as n2d::OutputExporter does;
+ * \li "multiframe": a single Multi-frame True Color Secondary Capture Image,
+ *     the frames being the slices, with the tags of the first slice. The
+ *     frames are packed in parallel.
+ *
+ * Only the tags of the dictionaries with a string VR are written, the
+ * geometry of each slice (Image Position, Image Orientation and Pixel
+ * Spacing) is computed from the image. Incremental and resumed conversions
+ * are not supported.
+ */
+class ColorExporter
+{
+public:
+    ColorExporter(const OutputArgs& outputArgs, ImageType::ConstPointer image, DictionaryArrayType& dictionaryArray) :
+            m_OutputArgs(outputArgs),
+            m_Image(image),
+            m_DictionaryArray(dictionaryArray)
+    {
+    }
+
+    ~ColorExporter() {}
+
+    bool Export( void );
+
+private:
+    const OutputArgs& m_OutputArgs;
+    ImageType::ConstPointer m_Image;
+    DictionaryArrayType& m_DictionaryArray;
+};
+//END class n2d::ColorExporter
+
+} // namespace n2d
+
+#endif // N2DCOLOREXPORTER_H
@@ -19,6 +19,13 @@
 
 #include "n2dCommandLineParser.h"
 #include "n2dVersion.h"
+#include "n2dToolsPathTemplate.h"
+#include "n2dToolsSliceRange.h"
+#include "n2dToolsResampling.h"
+#include "n2dToolsImageStatistics.h"
+#include "n2dToolsSocket.h"
+#include "n2dToolsStoreSCU.h"
+#include "n2dToolsStowClient.h"
 
 
 namespace n2d {
@@ -71,7 +78,19 @@ bool CommandLineParser::Parse(int argc, char* argv[])
         // -----------------------------------------------------------------------------
 
         TCLAP::ValueArg<std::string> dicomheaderfileArg ( "d", "dicomheaderfile",
-                "File containing DICOM header to import",
+                "File containing DICOM header to import, or directory containing a DICOM series "
+                "whose per-slice attributes are copied to the slices at the same position",
+                false, "",
+                "string",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Dicom header cache
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> headercacheArg ( "", "header-cache",
+                "Directory where the imported DICOM headers are cached, so that repeated conversions "
+                "with the same unchanged DICOM header file or directory do not read it again",
                 false, "",
                 "string",
                 cmd);
@@ -450,12 +469,34 @@ bool CommandLineParser::Parse(int argc, char* argv[])
         // -----------------------------------------------------------------------------
 
         TCLAP::ValueArg<std::string> inputArg ( "i", "inputfile",
-                "Input NIFTI 1 file",
+                "Input NIfTI-1 or NIfTI-2 file",
                 true, "",
                 "string",
                 cmd);
 
-     
+        // -----------------------------------------------------------------------------
+        // Slice range
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> slicerangeArg ( "", "slice-range",
+                "Only convert the slices start:end (counted from 0, end excluded, \"start:\" up to the last one). "
+                "Instance numbers and positions are those of the whole volume, so that a series can be split "
+                "across several conversions sharing the same --studyinstanceuid and --seriesinstanceuid",
+                false, "",
+                "start:end",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Slabs
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<unsigned int> slabArg ( "", "slab",
+                "Read, filter and write N slices at a time, so that volumes larger than the memory can be converted. "
+                "Needs --output-type, no --reorient, rescaling, resampling, window or cropping, and an input whose slices can be read on their own (e.g. not .nii.gz)",
+                false, 0,
+                "N",
+                cmd);
+
     //END Input command line arguments
 
 
@@ -466,10 +507,17 @@ bool CommandLineParser::Parse(int argc, char* argv[])
         // -----------------------------------------------------------------------------
 
         TCLAP::SwitchArg rescaleSwitch ( "r", "rescale",
-                "Rescale image before exporting",
+                "Rescale image before exporting. --rescale=percentile:low,high is --rescale --rescale-percentiles low,high",
                 cmd,
                 false);
 
+        TCLAP::ValueArg<std::string> rescalepercentilesArg ( "", "rescale-percentiles",
+                "Rescale the values between these percentiles (default: the minimum and maximum), "
+                "clamping the values outside",
+                false, "0,100",
+                "low,high",
+                cmd);
+
         // -----------------------------------------------------------------------------
         // Reorient image
         // Khan lab, date: 2021.04.12
@@ -481,6 +529,76 @@ bool CommandLineParser::Parse(int argc, char* argv[])
             "string",
             cmd);
 
+        // -----------------------------------------------------------------------------
+        // Output pixel type
+        // -----------------------------------------------------------------------------
+
+        std::vector<std::string> outputtypeVec;
+        outputtypeVec.push_back("auto");
+        outputtypeVec.push_back("uint8");
+        outputtypeVec.push_back("uint16");
+        outputtypeVec.push_back("int16");
+        outputtypeVec.push_back("uint32");
+        TCLAP::ValuesConstraint<std::string> outputtypeCon(outputtypeVec);
+        TCLAP::ValueArg<std::string> outputtypeArg ( "", "output-type",
+                "Pixel type of the DICOM series. \"auto\" picks the smallest type that holds the image losslessly",
+                false, "auto",
+                &outputtypeCon,
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Window
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> windowArg ( "", "window",
+                "Percentiles of the values spanned by (0028,1050) Window Center and (0028,1051) Window Width "
+                "(e.g. \"1,99\"), by default (\"none\") the window of the DICOM header is kept",
+                false, "none",
+                "low,high",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Resampling
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> resampleArg ( "", "resample",
+                "Resample the image, after reorientation, to a spacing (e.g. \"spacing:1\" for 1 mm isotropic voxels) "
+                "or to a size (e.g. \"size:256,256,0\"). 0 keeps the axis",
+                false, "",
+                "spacing:x[,y,z]|size:x[,y,z]",
+                cmd);
+
+        std::vector<std::string> interpolationVec;
+        interpolationVec.push_back("linear");
+        interpolationVec.push_back("nearest");
+        interpolationVec.push_back("bspline");
+        TCLAP::ValuesConstraint<std::string> interpolationCon(interpolationVec);
+        TCLAP::ValueArg<std::string> interpolationArg ( "", "interpolation",
+                "Interpolation used by --resample",
+                false, "linear",
+                &interpolationCon,
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Crop to content
+        // -----------------------------------------------------------------------------
+
+        TCLAP::SwitchArg cropSwitch ( "", "crop-to-content",
+                "Write only the bounding box of the pixels that are not background (0 before rescaling). "
+                "--crop-to-content=margin is --crop-to-content --crop-margin margin",
+                cmd,
+                false);
+
+        TCLAP::ValueArg<unsigned int> cropmarginArg ( "", "crop-margin",
+                "Pixels kept around the bounding box on each side by --crop-to-content",
+                false, 0,
+                "unsigned int",
+                cmd);
+
+        TCLAP::SwitchArg slicepixelrangeSwitch ( "", "slice-pixel-range",
+                "Write (0028,0106) Smallest and (0028,0107) Largest Image Pixel Value of each slice (16 bits or less)",
+                cmd,
+                false);
 
     //END Filters command line arguments
 
@@ -493,9 +611,87 @@ bool CommandLineParser::Parse(int argc, char* argv[])
         // -----------------------------------------------------------------------------
 
         TCLAP::ValueArg<std::string> outputArg ( "o", "outputdirectory",
-                "Output dicom directory",
+                "Output dicom directory, \"-\" to write a stream on the standard output",
                 true,
-                "", "string",
+                "", "string");
+
+        // -----------------------------------------------------------------------------
+        // DICOM Output archive
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> outputarchiveArg ( "", "output-archive",
+                "Output tar archive, used instead of the output directory (.tar.zst to compress it)",
+                true,
+                "", "string");
+
+        // -----------------------------------------------------------------------------
+        // DICOM Storage SCP
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> storescuArg ( "", "store-scu",
+                "Send the slices to a DICOM Storage SCP (\"host:port\") instead of writing them",
+                true,
+                "", "string");
+
+        // -----------------------------------------------------------------------------
+        // DICOMweb STOW-RS endpoint
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> stowrsArg ( "", "stow-rs",
+                "Post the slices to a DICOMweb STOW-RS endpoint (e.g. \"http://host:8080/dicom-web/studies\") instead of writing them",
+                true,
+                "", "string");
+
+        std::vector<TCLAP::Arg*> outputArgsVec;
+        outputArgsVec.push_back(&outputArg);
+        outputArgsVec.push_back(&outputarchiveArg);
+        outputArgsVec.push_back(&storescuArg);
+        outputArgsVec.push_back(&stowrsArg);
+        cmd.xorAdd( outputArgsVec );
+
+        TCLAP::ValueArg<std::string> calledaetArg ( "", "called-aet",
+                "AE title of the Storage SCP",
+                false,
+                "ANY-SCP", "string",
+                cmd);
+
+        TCLAP::ValueArg<std::string> callingaetArg ( "", "calling-aet",
+                "AE title used to send the slices to the Storage SCP",
+                false,
+                "NIFTI2DICOM", "string",
+                cmd);
+
+        TCLAP::ValueArg<unsigned int> stowbatchArg ( "", "stow-batch",
+                "Number of slices posted in each STOW-RS request",
+                false,
+                50, "unsigned int",
+                cmd);
+
+        TCLAP::ValueArg<unsigned int> stowconnectionsArg ( "", "stow-connections",
+                "Number of STOW-RS requests sent in parallel",
+                false,
+                2, "unsigned int",
+                cmd);
+
+        TCLAP::ValueArg<unsigned int> networktimeoutArg ( "", "network-timeout",
+                "Seconds to wait for the Storage SCP or the STOW-RS server to answer before failing, 0 waits forever",
+                false,
+                60, "unsigned int",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Standard output stream format
+        // -----------------------------------------------------------------------------
+
+        std::vector<std::string> streamformatVec;
+        streamformatVec.push_back("tar");
+        streamformatVec.push_back("tar.zst");
+        streamformatVec.push_back("length-prefixed");
+        TCLAP::ValuesConstraint<std::string> streamformatCon(streamformatVec);
+        TCLAP::ValueArg<std::string> streamformatArg ( "", "stream-format",
+                "Format of the stream written when the output directory is \"-\"",
+                false, "tar",
+                &streamformatCon,
                 cmd);
 
         // -----------------------------------------------------------------------------
@@ -529,6 +725,103 @@ bool CommandLineParser::Parse(int argc, char* argv[])
                 4, "int",
                 cmd);
 
+        // -----------------------------------------------------------------------------
+        // Output layout
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<std::string> layoutArg ( "", "layout",
+                "Template of the path of each slice, relative to the output, filled with DICOM tags and the {Instance} number "
+                "(e.g. \"{StudyUID}/{SeriesNumber}/{Instance:05}.dcm\" or \"{Shard:2}/{SeriesUID}/{Instance}.dcm\"). "
+                "Overrides prefix, suffix and digits",
+                false,
+                "", "string",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Incremental conversion
+        // -----------------------------------------------------------------------------
+
+        TCLAP::SwitchArg incrementalSwitch ( "", "incremental",
+                "Only write the slices whose pixels or tags changed since the previous conversion in the same output directory",
+                cmd,
+                false);
+
+        // -----------------------------------------------------------------------------
+        // Resumable conversion
+        // -----------------------------------------------------------------------------
+
+        TCLAP::SwitchArg resumeSwitch ( "", "resume",
+                "Record the completed slices in a journal in the output directory, "
+                "and skip the slices already completed by an interrupted conversion run with this option",
+                cmd,
+                false);
+
+        // -----------------------------------------------------------------------------
+        // DICOM Segmentation
+        // -----------------------------------------------------------------------------
+
+        TCLAP::SwitchArg segmentationSwitch ( "", "segmentation",
+                "The input is a label map: write a single DICOM Segmentation (BINARY, one segment per label other than 0) "
+                "in the study of the reference header, instead of a series of slices",
+                cmd,
+                false);
+
+        // -----------------------------------------------------------------------------
+        // Color images
+        // -----------------------------------------------------------------------------
+
+        std::vector<std::string> coloriodVec;
+        coloriodVec.push_back("sc");
+        coloriodVec.push_back("multiframe");
+        TCLAP::ValuesConstraint<std::string> coloriodCon(coloriodVec);
+        TCLAP::ValueArg<std::string> coloriodArg ( "", "color-iod",
+                "IOD of RGB and RGBA images: one Secondary Capture image per slice (sc) "
+                "or a single Multi-frame True Color Secondary Capture image (multiframe)",
+                false,
+                "sc", &coloriodCon,
+                cmd);
+
+        TCLAP::SwitchArg planarSwitch ( "", "planar",
+                "Write RGB and RGBA images with one plane per component (Planar Configuration 1) instead of interleaved components",
+                cmd,
+                false);
+
+        // -----------------------------------------------------------------------------
+        // Asynchronous slice writes
+        // -----------------------------------------------------------------------------
+
+        TCLAP::ValueArg<unsigned int> writequeueArg ( "", "write-queue",
+                "Number of slice writes kept in flight (0 writes one slice at a time). "
+                "With --store-scu, number of outstanding C-STORE requests proposed to the SCP (0 proposes 16)",
+                false,
+                0, "unsigned int",
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Durability policy
+        // -----------------------------------------------------------------------------
+
+        std::vector<std::string> syncVec;
+        syncVec.push_back("none");
+        syncVec.push_back("series");
+        syncVec.push_back("file");
+        TCLAP::ValuesConstraint<std::string> syncCon(syncVec);
+        TCLAP::ValueArg<std::string> syncArg ( "", "sync",
+                "Flush output to stable storage: never, once at the end of the series, or after each file",
+                false, "none",
+                &syncCon,
+                cmd);
+
+        // -----------------------------------------------------------------------------
+        // Probe
+        // -----------------------------------------------------------------------------
+
+        TCLAP::SwitchArg probeSwitch ( "", "probe",
+                "Do not convert, only read the header of the input image and print a JSON plan of the conversion "
+                "(sizes, pixel types, slices, output bytes per transfer syntax and peak memory)",
+                cmd,
+                false);
+
     //END Output command line arguments
 
 
@@ -538,7 +831,39 @@ bool CommandLineParser::Parse(int argc, char* argv[])
 
 
 //BEGIN Command line arguments parsing
-        cmd.parse( argc, argv );
+        // TCLAP switches take no value: --rescale=minmax,
+        // --rescale=percentile:low,high and --crop-to-content=margin are
+        // rewritten as separate arguments.
+        std::vector<std::string> args;
+        for (int i = 0; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg.compare(0, 10, "--rescale=") == 0)
+            {
+                const std::string mode = arg.substr(10);
+                args.push_back("--rescale");
+                if (mode.compare(0, 11, "percentile:") == 0)
+                {
+                    args.push_back("--rescale-percentiles");
+                    args.push_back(mode.substr(11));
+                }
+                else if (mode != "minmax")
+                {
+                    throw TCLAP::ArgParseException("unknown rescale mode \"" + mode + "\", expected minmax or percentile:low,high", rescaleSwitch.toString());
+                }
+            }
+            else if (arg.compare(0, 18, "--crop-to-content=") == 0)
+            {
+                args.push_back("--crop-to-content");
+                args.push_back("--crop-margin");
+                args.push_back(arg.substr(18));
+            }
+            else
+            {
+                args.push_back(arg);
+            }
+        }
+        cmd.parse( args );
 //END Command line arguments parsing
 
 
@@ -556,6 +881,7 @@ bool CommandLineParser::Parse(int argc, char* argv[])
         //BEGIN DICOM header command line arguments
         if (dicomheaderfileArg.isSet())
             dicomHeaderArgs.dicomheaderfile = dicomheaderfileArg.getValue();
+        dicomHeaderArgs.headercache = headercacheArg.getValue();
         //END DICOM header command line arguments
 
 
@@ -629,27 +955,126 @@ bool CommandLineParser::Parse(int argc, char* argv[])
 
         //BEGIN Input command line arguments
         inputArgs.inputfile       = inputArg.getValue();
+        inputArgs.slab            = slabArg.getValue();
         //END Input command line arguments
 
 
 
         //BEGIN Filters command line arguments
-        filtersArgs.rescale         = rescaleSwitch.getValue();
+        filtersArgs.rescale         = rescaleSwitch.getValue() || rescalepercentilesArg.isSet();
+        if (!tools::ImageStatistics::ParsePercentiles(rescalepercentilesArg.getValue(), filtersArgs.rescalelow, filtersArgs.rescalehigh))
+            throw TCLAP::ArgParseException("expected \"low,high\" percentiles, 0 <= low < high <= 100", rescalepercentilesArg.toString());
 
         ///////////////////////
         //Khan lab
         //date: 2021.04.12
         ///////////////////////
         filtersArgs.reorient = reorientArg.getValue();
+        filtersArgs.outputtype = outputtypeArg.getValue();
+        filtersArgs.window = (windowArg.getValue() != "none");
+        if (filtersArgs.window && !tools::ImageStatistics::ParsePercentiles(windowArg.getValue(), filtersArgs.windowlow, filtersArgs.windowhigh))
+            throw TCLAP::ArgParseException("expected \"low,high\" percentiles, 0 <= low < high <= 100", windowArg.toString());
+        filtersArgs.slicepixelrange = slicepixelrangeSwitch.getValue();
+        if (resampleArg.isSet() && !tools::ParseResampling(resampleArg.getValue(), filtersArgs.resample, filtersArgs.resamplevalues))
+            throw TCLAP::ArgParseException("invalid resampling \"" + resampleArg.getValue() + "\"", resampleArg.toString());
+        filtersArgs.interpolation = interpolationArg.getValue();
+        filtersArgs.crop = cropSwitch.getValue() || cropmarginArg.isSet();
+        filtersArgs.cropmargin = cropmarginArg.getValue();
+        if (slicerangeArg.isSet())
+        {
+            if (!tools::ParseSliceRange(slicerangeArg.getValue(), filtersArgs.slicestart, filtersArgs.sliceend))
+                throw TCLAP::ArgParseException("invalid slice range \"" + slicerangeArg.getValue() + "\"", slicerangeArg.toString());
+
+            // Only the slices in the range need to be read if the slices of
+            // the input are those of the output and neither their values
+            // nor their window depend on the rest of the volume: every range
+            // of a series split across processes gets the same tags.
+            if (filtersArgs.reorient == "NO_REORIENT" && !filtersArgs.rescale && filtersArgs.outputtype != "auto" &&
+                filtersArgs.resample == "none" && !filtersArgs.window)
+            {
+                inputArgs.slicestart = filtersArgs.slicestart;
+                inputArgs.sliceend = filtersArgs.sliceend;
+            }
+        }
 
         //END Filters command line arguments
 
 
         //BEGIN Output command line arguments
         outputArgs.outputdirectory = outputArg.getValue();
+        outputArgs.outputarchive   = outputarchiveArg.getValue();
+        outputArgs.streamformat    = streamformatArg.getValue();
+        outputArgs.storescu        = storescuArg.getValue();
+        outputArgs.calledaet       = calledaetArg.getValue();
+        outputArgs.callingaet      = callingaetArg.getValue();
+        if (!outputArgs.storescu.empty())
+        {
+            std::string host;
+            unsigned short port;
+            if (!tools::Socket::ParseAddress(outputArgs.storescu, host, port))
+                throw TCLAP::ArgParseException("expected \"host:port\"", storescuArg.toString());
+        }
+        outputArgs.stowrs          = stowrsArg.getValue();
+        outputArgs.stowbatch       = stowbatchArg.getValue();
+        outputArgs.stowconnections = stowconnectionsArg.getValue();
+        outputArgs.networktimeout  = networktimeoutArg.getValue();
+        if (!outputArgs.stowrs.empty())
+        {
+            std::string host, path;
+            unsigned short port;
+            if (!tools::StowClient::ParseURL(outputArgs.stowrs, host, port, path))
+                throw TCLAP::ArgParseException("expected \"http://host[:port]/path\"", stowrsArg.toString());
+        }
+        if (outputArgs.stowbatch == 0)
+            throw TCLAP::ArgParseException("must be at least 1", stowbatchArg.toString());
+        if (outputArgs.stowconnections == 0)
+            throw TCLAP::ArgParseException("must be at least 1", stowconnectionsArg.toString());
+        if (!tools::StoreSCU::IsValidAETitle(outputArgs.calledaet))
+            throw TCLAP::ArgParseException("AE titles are 1 to 16 characters long", calledaetArg.toString());
+        if (!tools::StoreSCU::IsValidAETitle(outputArgs.callingaet))
+            throw TCLAP::ArgParseException("AE titles are 1 to 16 characters long", callingaetArg.toString());
         outputArgs.prefix          = prefixArg.getValue();
         outputArgs.suffix          = suffixArg.getValue();
         outputArgs.digits          = digitsArg.getValue();
+        outputArgs.writequeue      = writequeueArg.getValue();
+        outputArgs.sync            = syncArg.getValue();
+        outputArgs.layout          = layoutArg.getValue();
+        outputArgs.incremental     = incrementalSwitch.getValue();
+        if (outputArgs.incremental && (outputArgs.outputdirectory.empty() || outputArgs.outputdirectory == "-"))
+            throw TCLAP::ArgParseException("incremental conversions need an output directory", incrementalSwitch.toString());
+        outputArgs.resume          = resumeSwitch.getValue();
+        if (outputArgs.resume && (outputArgs.outputdirectory.empty() || outputArgs.outputdirectory == "-"))
+            throw TCLAP::ArgParseException("resumable conversions need an output directory", resumeSwitch.toString());
+        // The manifest and the journal describe the whole output directory,
+        // processes converting other slice ranges into it would overwrite them.
+        if ((outputArgs.incremental || outputArgs.resume) && slicerangeArg.isSet())
+            throw TCLAP::ArgParseException("incremental and resumable conversions cannot be split into slice ranges", slicerangeArg.toString());
+        outputArgs.probe           = probeSwitch.getValue();
+        outputArgs.segmentation    = segmentationSwitch.getValue();
+        if (outputArgs.segmentation && filtersArgs.rescale)
+            throw TCLAP::ArgParseException("a Segmentation keeps the labels, it cannot be rescaled", segmentationSwitch.toString());
+        if (outputArgs.segmentation && (outputArgs.incremental || outputArgs.resume || !outputArgs.layout.empty()))
+            throw TCLAP::ArgParseException("a Segmentation is a single file, it cannot be written incrementally, resumed or laid out", segmentationSwitch.toString());
+        outputArgs.coloriod        = coloriodArg.getValue();
+        outputArgs.planar          = planarSwitch.getValue();
+        if (!outputArgs.layout.empty())
+        {
+            tools::PathTemplate layout;
+            if (!layout.Parse(outputArgs.layout))
+                throw TCLAP::ArgParseException(layout.GetError(), layoutArg.toString());
+        }
+        if (inputArgs.slab > 0)
+        {
+            // Each slab is read as a slice range (see above) and written on
+            // its own, its values cannot depend on the rest of the volume.
+            if (filtersArgs.reorient != "NO_REORIENT" || filtersArgs.rescale || filtersArgs.outputtype == "auto" ||
+                filtersArgs.resample != "none" || filtersArgs.window || filtersArgs.crop)
+                throw TCLAP::ArgParseException("slabs need --output-type, and no --reorient, rescaling, resampling, window or cropping", slabArg.toString());
+            if (outputArgs.incremental || outputArgs.resume || outputArgs.segmentation || outputArgs.coloriod == "multiframe")
+                throw TCLAP::ArgParseException("slabs are written one slice at a time, not incrementally, resumed, as a Segmentation or as a multi-frame image", slabArg.toString());
+            if (!outputArgs.outputarchive.empty() || (outputArgs.outputdirectory == "-" && outputArgs.streamformat != "length-prefixed"))
+                throw TCLAP::ArgParseException("an archive would be closed after the first slab", slabArg.toString());
+        }
         //END Output command line arguments
 
 //END Populating structs
@@ -688,6 +1113,7 @@ void CommandLineParser::DebugPrint( void )
 //BEGIN DICOM header
     std::cout << "DICOM Header:" << std::endl;
     std::cout << "              dicomheaderfile             = " << dicomHeaderArgs.dicomheaderfile << std::endl;
+    std::cout << "              headercache                 = " << dicomHeaderArgs.headercache << std::endl;
     std::cout << "-----------------------------------------" << std::endl;
 //END DICOM header
 
@@ -755,15 +1181,32 @@ void CommandLineParser::DebugPrint( void )
 //BEGIN Input
     std::cout << "Input:" << std::endl;
     std::cout << "              inputfile                   = " << inputArgs.inputfile << std::endl;
+    std::cout << "              slicestart                  = " << inputArgs.slicestart << std::endl;
+    std::cout << "              sliceend                    = " << inputArgs.sliceend << std::endl;
+    std::cout << "              slab                        = " << inputArgs.slab << std::endl;
     std::cout << "-----------------------------------------" << std::endl;
 //END Input
 
 //BEGIN Filter
     std::cout << "Filter:" << std::endl;
     std::cout << "              rescale                     = " << filtersArgs.rescale         << std::endl;
+    std::cout << "              rescalelow                  = " << filtersArgs.rescalelow      << std::endl;
+    std::cout << "              rescalehigh                 = " << filtersArgs.rescalehigh     << std::endl;
     //Khan lab
     //date:2021.04.12
     std::cout << "              reorient                     = " << filtersArgs.reorient << std::endl;
+    std::cout << "              outputtype                  = " << filtersArgs.outputtype      << std::endl;
+    std::cout << "              slicestart                  = " << filtersArgs.slicestart      << std::endl;
+    std::cout << "              sliceend                    = " << filtersArgs.sliceend        << std::endl;
+    std::cout << "              window                      = " << filtersArgs.window          << std::endl;
+    std::cout << "              windowlow                   = " << filtersArgs.windowlow       << std::endl;
+    std::cout << "              windowhigh                  = " << filtersArgs.windowhigh      << std::endl;
+    std::cout << "              slicepixelrange             = " << filtersArgs.slicepixelrange << std::endl;
+    std::cout << "              resample                    = " << filtersArgs.resample        << " "
+              << filtersArgs.resamplevalues[0] << "," << filtersArgs.resamplevalues[1] << "," << filtersArgs.resamplevalues[2] << std::endl;
+    std::cout << "              interpolation               = " << filtersArgs.interpolation   << std::endl;
+    std::cout << "              crop                        = " << filtersArgs.crop            << std::endl;
+    std::cout << "              cropmargin                  = " << filtersArgs.cropmargin      << std::endl;
     std::cout << "-----------------------------------------" << std::endl;
 //END Filter
 
@@ -775,9 +1218,27 @@ void CommandLineParser::DebugPrint( void )
 //BEGIN Output
     std::cout << "Output:" << std::endl;
     std::cout << "              outputdirectory             = " << outputArgs.outputdirectory << std::endl;
+    std::cout << "              outputarchive               = " << outputArgs.outputarchive << std::endl;
+    std::cout << "              streamformat                = " << outputArgs.streamformat << std::endl;
+    std::cout << "              storescu                    = " << outputArgs.storescu << std::endl;
+    std::cout << "              calledaet                   = " << outputArgs.calledaet << std::endl;
+    std::cout << "              callingaet                  = " << outputArgs.callingaet << std::endl;
+    std::cout << "              stowrs                      = " << outputArgs.stowrs << std::endl;
+    std::cout << "              stowbatch                   = " << outputArgs.stowbatch << std::endl;
+    std::cout << "              stowconnections             = " << outputArgs.stowconnections << std::endl;
+    std::cout << "              networktimeout              = " << outputArgs.networktimeout << std::endl;
     std::cout << "              suffix                      = " << outputArgs.suffix << std::endl;
     std::cout << "              prefix                      = " << outputArgs.prefix << std::endl;
     std::cout << "              digits                      = " << outputArgs.digits << std::endl;
+    std::cout << "              writequeue                  = " << outputArgs.writequeue << std::endl;
+    std::cout << "              sync                        = " << outputArgs.sync << std::endl;
+    std::cout << "              layout                      = " << outputArgs.layout << std::endl;
+    std::cout << "              incremental                 = " << outputArgs.incremental << std::endl;
+    std::cout << "              resume                      = " << outputArgs.resume << std::endl;
+    std::cout << "              probe                       = " << outputArgs.probe << std::endl;
+    std::cout << "              segmentation                = " << outputArgs.segmentation << std::endl;
+    std::cout << "              coloriod                    = " << outputArgs.coloriod << std::endl;
+    std::cout << "              planar                      = " << outputArgs.planar << std::endl;
     std::cout << "-----------------------------------------" << std::endl;
 //END Output
 }
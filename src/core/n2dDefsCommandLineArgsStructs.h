@@ -52,7 +52,8 @@ typedef struct AccessionNumberArgs
  */
 typedef struct DicomHeaderArgs
 {
-    std::string dicomheaderfile;
+    std::string dicomheaderfile; //!< DICOM file, or directory containing a DICOM series
+    std::string headercache; //!< Directory where imported headers are cached (see tools::HeaderCache)
 } DicomHeaderArgsArgs;
 //END struct n2d::DicomHeaderArgs
 
@@ -223,7 +224,12 @@ typedef struct AcquisitionArgs
  */
 typedef struct InputArgs
 {
+    InputArgs() : slicestart(0), sliceend(0), slab(0) {}
+
     std::string inputfile;
+    unsigned long long slicestart; //!< First slice to read (see FiltersArgs::slicestart)
+    unsigned long long sliceend; //!< Slice after the last one to read, 0 reads up to the last slice
+    unsigned int slab; //!< Slices read, filtered and written at a time, 0 converts the whole volume at once
 } InputArgs;
 //END struct n2d::InputArgs
 
@@ -233,11 +239,32 @@ typedef struct InputArgs
 /*!
  * \brief Contains all arguments read from command line related to filters.
  *
+ * The following tags are written according to \c outputtype:
+ *
+ * \li (0028,0100) Bits Allocated
+ * \li (0028,0101) Bits Stored
+ * \li (0028,0102) High Bit
+ * \li (0028,0103) Pixel Representation
+ *
+ * The following tags are written according to \c windowlow and \c windowhigh:
+ *
+ * \li (0028,1050) Window Center
+ * \li (0028,1051) Window Width
+ *
+ * The following tags are written when \c slicepixelrange is set:
+ *
+ * \li (0028,0106) Smallest Image Pixel Value
+ * \li (0028,0107) Largest Image Pixel Value
+ *
  * \todo orientation
  */
 typedef struct FiltersArgs
 {
-    FiltersArgs() : rescale(false) {}
+    FiltersArgs() : outputtype("auto"), rescale(false), rescalelow(0), rescalehigh(100), slicestart(0), sliceend(0), window(false), windowlow(1), windowhigh(99), slicepixelrange(false), resample("none"), interpolation("linear"),
+                    crop(false), cropmargin(0)
+    {
+        resamplevalues[0] = resamplevalues[1] = resamplevalues[2] = 0;
+    }
 
 //    std::string orientation; //TODO
     /////////////////////////
@@ -246,7 +273,21 @@ typedef struct FiltersArgs
     /////////////////////////
     std::string reorient;
 
+    std::string outputtype; //!< auto, uint8, uint16, int16 or uint32
     bool rescale;
+    double rescalelow; //!< Percentile of the values mapped to the bottom of the rescaled range, 0 is the minimum
+    double rescalehigh; //!< Percentile of the values mapped to the top of the rescaled range, 100 is the maximum
+    unsigned long long slicestart; //!< First slice of the output (after reorientation)
+    unsigned long long sliceend; //!< Slice after the last one of the output, 0 means the last slice
+    bool window; //!< Write Window Center and Width computed from the values
+    double windowlow; //!< Percentile of the values at the bottom of the window
+    double windowhigh; //!< Percentile of the values at the top of the window
+    bool slicepixelrange; //!< Write Smallest and Largest Image Pixel Value of each slice
+    std::string resample; //!< none, spacing or size
+    double resamplevalues[3]; //!< Spacing or size of each axis after reorientation, 0 keeps the axis
+    std::string interpolation; //!< linear, nearest or bspline
+    bool crop; //!< Crop the output to the bounding box of the pixels that are not background
+    unsigned int cropmargin; //!< Pixels kept around the bounding box on each side
 } FiltersArgs;
 //END struct n2d::FiltersArgs
 
@@ -273,10 +314,30 @@ typedef struct InstanceArgs
  */
 typedef struct OutputArgs
 {
-    std::string outputdirectory;
+    OutputArgs() : streamformat("tar"), calledaet("ANY-SCP"), callingaet("NIFTI2DICOM"), stowbatch(50), stowconnections(2), networktimeout(60), digits(4), writequeue(0), sync("none"), incremental(false), resume(false), probe(false), segmentation(false), coloriod("sc"), planar(false) {}
+
+    std::string outputdirectory; //!< "-" writes a stream to the standard output
+    std::string outputarchive; //!< tar archive (.tar or .tar.zst) used instead of outputdirectory
+    std::string streamformat; //!< tar, tar.zst or length-prefixed, used when outputdirectory is "-"
+    std::string storescu; //!< "host:port" of a Storage SCP the slices are sent to, used instead of outputdirectory
+    std::string calledaet; //!< AE title of the Storage SCP
+    std::string callingaet; //!< AE title used to send to the Storage SCP
+    std::string stowrs; //!< URL of a DICOMweb STOW-RS endpoint the slices are posted to, used instead of outputdirectory
+    unsigned int stowbatch; //!< Number of slices in each STOW-RS request
+    unsigned int stowconnections; //!< Number of STOW-RS requests sent in parallel
+    unsigned int networktimeout; //!< Seconds to wait for the Storage SCP or the STOW-RS server, 0 waits forever
     std::string suffix;
     std::string prefix;
     int digits;
+    unsigned int writequeue; //!< Number of slice writes kept in flight, 0 writes synchronously
+    std::string sync; //!< Durability policy: none, series (once at the end) or file (every slice)
+    std::string layout; //!< Template of the slice paths (see tools::PathTemplate), replaces prefix, digits and suffix
+    bool incremental; //!< Only write the slices changed since the previous conversion (see tools::Manifest)
+    bool resume; //!< Journal the completed slices and skip them if the conversion is run again (see tools::Journal)
+    bool probe; //!< Only print a JSON plan of the conversion, without reading the voxels (see Probe)
+    bool segmentation; //!< Write the label map as a DICOM Segmentation (see SegmentationExporter)
+    std::string coloriod; //!< IOD of color images: sc (one Secondary Capture per slice) or multiframe (see ColorExporter)
+    bool planar; //!< Write color images with one plane per component (Planar Configuration 1)
 } OutputArgs;
 //END struct n2d::OutputArgs
 
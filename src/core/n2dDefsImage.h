@@ -23,6 +23,7 @@
 #include <itkImage.h>
 #include <itkImageBase.h>
 #include <itkImageIOBase.h>
+#include <itkRGBPixel.h>
 
 
 namespace n2d {
@@ -32,12 +33,15 @@ const int Dimension = 3;
 const int DICOMDimension = 2;
 
 typedef itk::ImageIOBase::IOComponentType    PixelType;	
-typedef signed short DICOMPixelType;
+typedef signed short DICOMPixelType; //!< Default output pixel type (see FiltersArgs::outputtype)
 
 typedef itk::ImageBase<Dimension> ImageType;
 typedef itk::Image<DICOMPixelType, Dimension> DICOM3DImageType;
 typedef itk::Image<DICOMPixelType, DICOMDimension> DICOMImageType;
 
+typedef itk::RGBPixel<unsigned char> ColorPixelType; //!< Output pixel type of RGB and RGBA images (see ColorExporter)
+typedef itk::Image<ColorPixelType, Dimension> Color3DImageType;
+
 } // namespace n2d
 
 #endif // N2DDEFSIMAGE_H
@@ -20,17 +20,320 @@
 #include "n2dHeaderImporter.h"
 #include "n2dDefsIO.h"
 #include "n2dToolsMetaDataDictionary.h"
+#include "n2dToolsHeaderCache.h"
+
+#include <itksys/SystemTools.hxx>
+#include <itksys/Directory.hxx>
+#include <gdcmReader.h>
+#include <gdcmStringFilter.h>
+#include <gdcmGlobal.h>
+#include <gdcmDicts.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
 
 namespace n2d {
 
+//BEGIN DICOM tags
+const std::string seriesinstanceuidtag ( "0020|000e" );
+const std::string imagepositionpatienttag ( "0020|0032" );
+const std::string imageorientationpatienttag ( "0020|0037" );
+
+// Set for each slice by Nifti2Dicom, never copied from the reference series
+const char* const excludedslicetags[] = {
+    "0008|0018", // SOP Instance UID
+    "0018|0050", // Slice Thickness
+    "0020|0013", // Instance Number
+    "0020|0032", // Image Position (Patient)
+    "0020|0037", // Image Orientation (Patient)
+    NULL
+};
+//END DICOM tags
+
+
+
+namespace {
+
+struct ReferenceSlice
+{
+    std::string fileName;
+    DictionaryType dict;
+    bool valid;
+    double position; //!< Position along the normal
+};
+
+
+bool IsExcludedSliceTag( const std::string& key )
+{
+    // File meta information, group lengths, image pixel description
+    // (depends on the output pixel type) and pixel data
+    if (key.compare(0, 5, "0002|") == 0 || key.compare(0, 5, "0028|") == 0 ||
+        key.compare(0, 5, "7fe0|") == 0 || key.compare(5, 4, "0000") == 0)
+        return true;
+    for (const char* const* tag = excludedslicetags; *tag; ++tag)
+        if (key == *tag)
+            return true;
+    return false;
+}
+
+
+// Split a multi-valued decimal string
+bool ReadDecimals( const DictionaryType& dict, const std::string& tag, double* values, unsigned int count )
+{
+    std::string value;
+    if (!itk::ExposeMetaData<std::string>(dict, tag, value))
+        return false;
+    std::replace(value.begin(), value.end(), '\\', ' ');
+    std::istringstream stream(value);
+    for (unsigned int i = 0; i < count; ++i)
+        if (!(stream >> values[i]))
+            return false;
+    return true;
+}
+
+
+/*
+ * Read the header of a DICOM file, stopping before the pixel data, and
+ * store its string, number and date elements in the dictionary with the
+ * same keys used by itk::GDCMImageIO. Private, binary and sequence
+ * elements are skipped.
+ */
+bool ReadHeader( const std::string& fileName, DictionaryType& dict )
+{
+    gdcm::Reader reader;
+    reader.SetFileName( fileName.c_str() );
+    std::set<gdcm::Tag> skipTags;
+    if (!reader.ReadUpToTag( gdcm::Tag(0x7fe0, 0x0010), skipTags ))
+        return false;
+
+    const gdcm::File& file = reader.GetFile();
+    const gdcm::DataSet& dataSet = file.GetDataSet();
+    const gdcm::Dicts& dicts = gdcm::Global::GetInstance().GetDicts();
+    gdcm::StringFilter filter;
+    filter.SetFile( file );
+
+    for (gdcm::DataSet::ConstIterator it = dataSet.Begin(); it != dataSet.End(); ++it)
+    {
+        const gdcm::Tag& tag = it->GetTag();
+        if (tag.IsPrivate() || tag.IsGroupLength())
+            continue;
+
+        gdcm::VR::VRType vr = it->GetVR();
+        if (vr == gdcm::VR::INVALID || vr == gdcm::VR::UN)
+            vr = dicts.GetDictEntry(tag).GetVR(); // Implicit VR
+        if (vr == gdcm::VR::INVALID || (vr & (gdcm::VR::OB | gdcm::VR::OW | gdcm::VR::OF | gdcm::VR::OD |
+                                              gdcm::VR::OL | gdcm::VR::UN | gdcm::VR::SQ)))
+            continue;
+
+        const std::pair<std::string, std::string> value = filter.ToStringPair( tag );
+        itk::EncapsulateMetaData<std::string>(dict, tag.PrintAsPipeSeparatedString(), value.second);
+    }
+    return true;
+}
+
+
+void ScanHeaders( std::vector<ReferenceSlice>* slices, std::atomic<std::size_t>* next )
+{
+    std::size_t i;
+    while ((i = (*next)++) < slices->size())
+        (*slices)[i].valid = ReadHeader((*slices)[i].fileName, (*slices)[i].dict);
+}
+
+} // namespace
+
+
+
 bool HeaderImporter::Import( void )
 {
 
-    if (!m_DicomHeaderArgs.dicomheaderfile.empty())
+    if (m_DicomHeaderArgs.dicomheaderfile.empty())
+        return true;
+
+    // Headers already imported by a previous conversion
+    tools::HeaderCache cache(m_DicomHeaderArgs.headercache);
+    const bool cached = !m_DicomHeaderArgs.headercache.empty() && cache.Open(m_DicomHeaderArgs.dicomheaderfile);
+    if (cached && cache.Load(m_Dictionary, m_SliceHeaders))
+    {
+        std::cout << " * \033[1;34mReading DICOM Header\033[0m... \033[1;32mDONE\033[0m (cached)" << std::endl;
+        return true;
+    }
+
+    if (itksys::SystemTools::FileIsDirectory(m_DicomHeaderArgs.dicomheaderfile))
     {
-        if (!ReadDICOMTags(m_DicomHeaderArgs.dicomheaderfile))
+        if (!ReadDICOMSeries(m_DicomHeaderArgs.dicomheaderfile))
             return false;
     }
+    else if (!ReadDICOMTags(m_DicomHeaderArgs.dicomheaderfile))
+        return false;
+
+    if (cached && !cache.Store(m_Dictionary, m_SliceHeaders))
+        std::cerr << "WARNING: Cannot write the header cache in \"" << m_DicomHeaderArgs.headercache << "\"." << std::endl;
+    return true;
+}
+
+
+
+bool HeaderImporter::ReadDICOMSeries( const std::string& directory )
+{
+    std::cout << " * \033[1;34mReading DICOM Series Headers\033[0m... " << std::endl;
+
+    std::vector<ReferenceSlice> slices;
+    itksys::Directory dir;
+    if (dir.Load(directory))
+    {
+        for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+        {
+            const std::string name = dir.GetFile(i);
+            const std::string fileName = directory + "/" + name;
+            if (name.empty() || name[0] == '.' || itksys::SystemTools::FileIsDirectory(fileName))
+                continue;
+            slices.push_back(ReferenceSlice());
+            slices.back().fileName = fileName;
+            slices.back().valid = false;
+        }
+    }
+
+    // Only headers are read, so this is bound by file system latency:
+    // keep several reads in flight.
+    std::atomic<std::size_t> next(0);
+    unsigned int nbThreads = std::thread::hardware_concurrency();
+    if (nbThreads < 4)
+        nbThreads = 4;
+    if (nbThreads > slices.size())
+        nbThreads = static_cast<unsigned int>(slices.size());
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < nbThreads; ++i)
+        threads.push_back(std::thread(ScanHeaders, &slices, &next));
+    ScanHeaders(&slices, &next);
+    for (std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    // Files of other series in the same directory are ignored
+    std::map<std::string, unsigned int> seriesCount;
+    for (std::size_t i = 0; i < slices.size(); ++i)
+    {
+        std::string uid;
+        if (slices[i].valid && itk::ExposeMetaData<std::string>(slices[i].dict, seriesinstanceuidtag, uid))
+            ++seriesCount[uid];
+    }
+    std::string seriesUID;
+    unsigned int seriesSize = 0;
+    for (std::map<std::string, unsigned int>::const_iterator it = seriesCount.begin(); it != seriesCount.end(); ++it)
+    {
+        if (it->second > seriesSize)
+        {
+            seriesUID = it->first;
+            seriesSize = it->second;
+        }
+    }
+    if (seriesCount.empty())
+    {
+        std::cout << " * \033[1;34mReading DICOM Series Headers\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: No DICOM file found in \"" << directory << "\"." << std::endl;
+        return false;
+    }
+    if (seriesCount.size() > 1)
+        std::cerr << "WARNING: \"" << directory << "\" contains " << seriesCount.size()
+                  << " series, only " << seriesUID << " is used." << std::endl;
+
+    // Normal of the series, from the orientation of the first slice
+    double normal[3] = { 0.0, 0.0, 0.0 };
+    bool haveNormal = false;
+    std::vector<ReferenceSlice*> seriesSlices;
+    for (std::size_t i = 0; i < slices.size(); ++i)
+    {
+        std::string uid;
+        double orientation[6], position[3];
+        if (!slices[i].valid || !itk::ExposeMetaData<std::string>(slices[i].dict, seriesinstanceuidtag, uid) || uid != seriesUID ||
+            !ReadDecimals(slices[i].dict, imagepositionpatienttag, position, 3))
+            continue;
+        seriesSlices.push_back(&slices[i]);
+        if (!haveNormal && ReadDecimals(slices[i].dict, imageorientationpatienttag, orientation, 6))
+        {
+            normal[0] = orientation[1] * orientation[5] - orientation[2] * orientation[4];
+            normal[1] = orientation[2] * orientation[3] - orientation[0] * orientation[5];
+            normal[2] = orientation[0] * orientation[4] - orientation[1] * orientation[3];
+            const double norm = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (norm > 0.0)
+            {
+                for (int j = 0; j < 3; ++j)
+                    normal[j] /= norm;
+                haveNormal = true;
+            }
+        }
+    }
+    if (!haveNormal)
+    {
+        std::cout << " * \033[1;34mReading DICOM Series Headers\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: The series in \"" << directory << "\" has no image position and orientation." << std::endl;
+        return false;
+    }
+    for (std::size_t i = 0; i < seriesSlices.size(); ++i)
+    {
+        double position[3];
+        ReadDecimals(seriesSlices[i]->dict, imagepositionpatienttag, position, 3);
+        seriesSlices[i]->position = position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2];
+    }
+
+    // Attributes whose value is not the same in all the slices
+    std::map<std::string, std::string> firstValues;
+    std::set<std::string> sliceTags;
+    for (std::size_t i = 0; i < seriesSlices.size(); ++i)
+    {
+        std::set<std::string> found;
+        for (DictionaryType::ConstIterator it = seriesSlices[i]->dict.Begin(); it != seriesSlices[i]->dict.End(); ++it)
+        {
+            const MetaDataStringType* entry = dynamic_cast<const MetaDataStringType*>(it->second.GetPointer());
+            if (!entry || IsExcludedSliceTag(it->first))
+                continue;
+            found.insert(it->first);
+            if (i == 0)
+                firstValues[it->first] = entry->GetMetaDataObjectValue();
+            else if (!firstValues.count(it->first) || firstValues[it->first] != entry->GetMetaDataObjectValue())
+                sliceTags.insert(it->first);
+        }
+        // Missing in some slices
+        for (std::map<std::string, std::string>::const_iterator it = firstValues.begin(); it != firstValues.end(); ++it)
+            if (!found.count(it->first))
+                sliceTags.insert(it->first);
+    }
+
+    m_SliceHeaders.Reset(normal);
+    const ReferenceSlice* first = seriesSlices.front();
+    for (std::size_t i = 0; i < seriesSlices.size(); ++i)
+    {
+        if (seriesSlices[i]->position < first->position)
+            first = seriesSlices[i];
+
+        DictionaryType sliceDict;
+        for (std::set<std::string>::const_iterator tag = sliceTags.begin(); tag != sliceTags.end(); ++tag)
+        {
+            std::string value;
+            if (itk::ExposeMetaData<std::string>(seriesSlices[i]->dict, *tag, value))
+                itk::EncapsulateMetaData<std::string>(sliceDict, *tag, value);
+        }
+        m_SliceHeaders.Add(seriesSlices[i]->position, sliceDict);
+    }
+    m_SliceHeaders.Update();
+
+    std::cout << " * \033[1;34mReading DICOM Series Headers\033[0m... \033[1;32mDONE\033[0m ("
+              << seriesSlices.size() << " slices, " << sliceTags.size() << " per-slice attributes)" << std::endl;
+
+    // The attributes shared by all the slices are imported from the first
+    // slice, as the header of a single file
+    DictionaryType common;
+    for (DictionaryType::ConstIterator it = first->dict.Begin(); it != first->dict.End(); ++it)
+    {
+        const MetaDataStringType* entry = dynamic_cast<const MetaDataStringType*>(it->second.GetPointer());
+        if (entry && !sliceTags.count(it->first))
+            itk::EncapsulateMetaData<std::string>(common, it->first, entry->GetMetaDataObjectValue());
+    }
+    tools::CopyDictionary( common, m_Dictionary );
     return true;
 }
 
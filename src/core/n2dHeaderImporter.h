@@ -22,6 +22,7 @@
 
 #include "n2dDefsCommandLineArgsStructs.h"
 #include "n2dDefsMetadata.h"
+#include "n2dToolsSliceHeaderIndex.h"
 
 
 
@@ -32,14 +33,20 @@ namespace n2d {
 /*!
  * \brief Reads a DICOM file and imports its header
  *
+ * If a directory containing a DICOM series is given instead of a file, the
+ * headers of all the files are read, the header of the first slice is
+ * imported and the attributes that change from slice to slice are indexed
+ * by slice position, so that n2d::Instance can copy them to the output
+ * slices at the same position.
  */
 
 class HeaderImporter
 {
 public:
-    HeaderImporter(const DicomHeaderArgs& dicomHeaderArgs, DictionaryType& dict) :
+    HeaderImporter(const DicomHeaderArgs& dicomHeaderArgs, DictionaryType& dict, tools::SliceHeaderIndex& sliceHeaders) :
             m_DicomHeaderArgs(dicomHeaderArgs),
-            m_Dictionary(dict)
+            m_Dictionary(dict),
+            m_SliceHeaders(sliceHeaders)
     {
     }
 
@@ -58,9 +65,11 @@ public:
 
 private:
     bool ReadDICOMTags( std::string file );
+    bool ReadDICOMSeries( const std::string& directory );
 
     const DicomHeaderArgs& m_DicomHeaderArgs; //!< Input Arguments.
     n2d::DictionaryType &m_Dictionary;
+    tools::SliceHeaderIndex& m_SliceHeaders; //!< Per-slice attributes of a reference series.
 };
 //END class n2d::HeaderImporter
 
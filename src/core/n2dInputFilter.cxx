@@ -18,11 +18,22 @@
 
 
 #include "n2dInputFilter.h"
+#include "n2dToolsSliceRange.h"
+#include "n2dToolsResampling.h"
+#include "n2dToolsContentRegion.h"
 
-#include <itkRescaleIntensityImageFilter.h>
 #include <itkCastImageFilter.h>
 #include <itkOrientImageFilter.h>
+#include <itkExtractImageFilter.h>
+#include <itkResampleImageFilter.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkNumericTraits.h>
+#include <itkRGBAPixel.h>
+#include <algorithm>
 #include <sstream>
+#include <cmath>
 
 //original code
 //#define NO_REORIENT
@@ -32,84 +43,407 @@ namespace n2d {
 
 
 //BEGIN DICOM tags
-const std::string patientorientationtag ( "0020|0020" );
+const std::string patientorientationtag  ( "0020|0020" );
+const std::string bitsallocatedtag       ( "0028|0100" );
+const std::string bitsstoredtag          ( "0028|0101" );
+const std::string highbittag             ( "0028|0102" );
+const std::string pixelrepresentationtag ( "0028|0103" );
+const std::string windowcentertag        ( "0028|1050" );
+const std::string windowwidthtag         ( "0028|1051" );
 //END DICOM tags
 
 
 //BEGIN Default values
 const std::string defaultpatientorientation ( "L\\R" );
+const double rescaleminimum = 0;
+const double rescalemaximum = (1 << 11) - 1; // 11 bits
 //END Default values
 
 
-bool InputFilter::Filter( void )
+
+/*!
+ * \brief Linear transform of the values computed as
+ * itk::RescaleIntensityImageFilter does.
+ *
+ * The values between the percentiles \c low and \c high are mapped onto
+ * [rescaleminimum, rescalemaximum], 0 and 100 being the range of the image.
+ */
+static void GetRescaleTransform(const tools::ImageStatistics& statistics, double low, double high, double& factor, double& offset)
 {
+    const double minimum = low > 0 ? statistics.GetPercentile(low) : statistics.GetMinimum();
+    const double maximum = high < 100 ? statistics.GetPercentile(high) : statistics.GetMaximum();
+    if (maximum != minimum)
+        factor = (rescalemaximum - rescaleminimum) / (maximum - minimum);
+    else if (maximum != 0)
+        factor = (rescalemaximum - rescaleminimum) / maximum;
+    else
+        factor = 0.0;
+    offset = rescaleminimum - minimum * factor;
+}
 
-#ifdef DEBUG
-    std::cout << "InputFilter - BEGIN" << std::endl;
-    std::cout << "InputFilter::m_InputImage directions:" << std::endl;
-    std::cout << m_InputImage->GetDirection() << std::endl;
-#endif // DEBUG
 
-    bool ret=false;
 
-    switch(m_InputPixelType)
+/*!
+ * \brief Casts a pixel to the output pixel type.
+ *
+ * Values out of the range of the output pixel type are clamped, as
+ * RescalePixel does, instead of wrapping (NaN gives the minimum).
+ */
+template<class TPixel, class TOutputPixel> struct CastPixel
+{
+    inline TOutputPixel operator()(TPixel value) const
+    {
+        const double result = static_cast<double>(value);
+        if (!(result > static_cast<double>(itk::NumericTraits<TOutputPixel>::NonpositiveMin())))
+            return itk::NumericTraits<TOutputPixel>::NonpositiveMin();
+        if (result >= static_cast<double>(itk::NumericTraits<TOutputPixel>::max()))
+            return itk::NumericTraits<TOutputPixel>::max();
+        return static_cast<TOutputPixel>(value);
+    }
+};
+
+
+/*!
+ * \brief Whether all the values of \c TPixel are values of \c TOutputPixel.
+ */
+template<class TPixel, class TOutputPixel> static inline bool PixelTypeFits(void)
+{
+    return static_cast<double>(itk::NumericTraits<TPixel>::NonpositiveMin()) >= static_cast<double>(itk::NumericTraits<TOutputPixel>::NonpositiveMin()) &&
+           static_cast<double>(itk::NumericTraits<TPixel>::max()) <= static_cast<double>(itk::NumericTraits<TOutputPixel>::max());
+}
+
+
+/*!
+ * \brief Range of the values of \c TOutputPixel.
+ *
+ * \return true if all the values of \c TPixel are in the range.
+ */
+template<class TPixel, class TOutputPixel> static inline bool OutputPixelTypeFits(double& minimum, double& maximum)
+{
+    minimum = static_cast<double>(itk::NumericTraits<TOutputPixel>::NonpositiveMin());
+    maximum = static_cast<double>(itk::NumericTraits<TOutputPixel>::max());
+    return PixelTypeFits<TPixel, TOutputPixel>();
+}
+
+/*!
+ * \brief Range of the values of \c outputPixelType.
+ *
+ * \return true if all the values of \c TPixel are in the range.
+ */
+template<class TPixel> static bool OutputPixelTypeFits(PixelType outputPixelType, double& minimum, double& maximum)
+{
+    switch(outputPixelType)
     {
         case itk::ImageIOBase::UCHAR:
-        {
-            ret=InternalFilter<unsigned char>();
-            break;
-        }
-        case itk::ImageIOBase::CHAR:
-        {
-            ret=InternalFilter<char>();
-            break;
-        }
+            return OutputPixelTypeFits<TPixel, unsigned char>(minimum, maximum);
         case itk::ImageIOBase::USHORT:
-        {
-            ret=InternalFilter<unsigned short>();
-            break;
-        }
+            return OutputPixelTypeFits<TPixel, unsigned short>(minimum, maximum);
         case itk::ImageIOBase::SHORT:
+            return OutputPixelTypeFits<TPixel, signed short>(minimum, maximum);
+        default:
+            return OutputPixelTypeFits<TPixel, unsigned int>(minimum, maximum);
+    }
+}
+
+
+/*!
+ * \brief Rescales a pixel as itk::RescaleIntensityImageFilter does.
+ */
+template<class TPixel, class TOutputPixel> struct RescalePixel
+{
+    RescalePixel(double f, double o, double min, double max) : factor(f), offset(o), minimum(min), maximum(max) {}
+
+    inline TOutputPixel operator()(TPixel value) const
+    {
+        // Clamped before the conversion: values outside the percentiles
+        // of a robust rescale are out of the range of the output type.
+        double result = static_cast<double>(value) * factor + offset;
+        result = result > maximum ? maximum : result;
+        return static_cast<TOutputPixel>(result < minimum ? minimum : result);
+    }
+
+    double factor;
+    double offset;
+    double minimum;
+    double maximum;
+};
+
+
+/*!
+ * \brief Converts an RGB or RGBA pixel to 8 bits RGB.
+ *
+ * The components are multiplied by \c factor and, for RGBA pixels, by the
+ * alpha component multiplied by \c alphaFactor: the color is composited
+ * over black, DICOM has no alpha channel. All the components of a pixel are
+ * converted at once.
+ */
+template<class TPixel> struct ColorPixel
+{
+    ColorPixel(double f, double af) : factor(f), alphaFactor(af) {}
+
+    inline ColorPixelType operator()(const TPixel& value) const
+    {
+        const double scale = factor * Alpha(value);
+        ColorPixelType result;
+        for (unsigned int c = 0; c < 3; c++)
         {
-            ret=InternalFilter<short>();
-            break;
+            const double component = static_cast<double>(value[c]) * scale + 0.5;
+            result[c] = static_cast<unsigned char>(component < 0.0 ? 0.0 : (component > 255.0 ? 255.0 : component));
         }
-        case itk::ImageIOBase::UINT:
+        return result;
+    }
+
+    template<class TComponent> inline double Alpha(const itk::RGBPixel<TComponent>&) const { return 1.0; }
+    template<class TComponent> inline double Alpha(const itk::RGBAPixel<TComponent>& value) const { return static_cast<double>(value[3]) * alphaFactor; }
+
+    double factor;
+    double alphaFactor;
+};
+
+
+/*!
+ * \brief Merges the range of \c count pixels into \c minimum and \c maximum.
+ *
+ * Used on rows just written by CopyReorientedPixels(), which are still in
+ * cache.
+ */
+template<class TOutputPixel>
+static inline void MergePixelRange(const TOutputPixel* p, std::size_t count, double& minimum, double& maximum)
+{
+    if (count == 0)
+        return;
+    TOutputPixel low = p[0];
+    TOutputPixel high = p[0];
+    for (std::size_t i = 1; i < count; i++)
+    {
+        low = p[i] < low ? p[i] : low;
+        high = p[i] > high ? p[i] : high;
+    }
+    minimum = low < minimum ? low : minimum;
+    maximum = high > maximum ? high : maximum;
+}
+
+
+/*!
+ * \brief Color pixels have no range (see FiltersArgs::slicepixelrange).
+ */
+static inline void MergePixelRange(const ColorPixelType*, std::size_t, double&, double&)
+{
+}
+
+
+/*!
+ * \brief Copies the pixels of a reoriented image.
+ *
+ * Pixel (x, y, z) of the output is read at \c in + x * step[0] + y * step[1]
+ * + z * step[2]. Axis \c TUnitAxis of the output is the first axis of the
+ * input (step of +1 or -1). When this is not the first axis of the output,
+ * the copy is a transpose: it is done by square tiles, small enough to stay
+ * in cache, read along \c TUnitAxis and written along the first axis, so
+ * that the input and the output are not walked with a stride of a row or of
+ * a slice.
+ *
+ * If \c sliceMinimum and \c sliceMaximum are not null, the range of the
+ * values of each slice of the output is merged into them as it is written.
+ */
+template<unsigned int TUnitAxis, class TPixel, class TOutputPixel, class TConvert>
+static void CopyReorientedPixels(const TPixel* in, TOutputPixel* out, const std::size_t size[3], const long long step[3], const TConvert& convert,
+                                 double* sliceMinimum, double* sliceMaximum)
+{
+    const std::size_t tile = 64;
+    const std::size_t sliceSize = size[0] * size[1];
+
+    if (TUnitAxis == 0)
+    {
+        // Rows of the output are rows of the input
+        for (std::size_t z = 0; z < size[2]; z++)
         {
-            ret=InternalFilter<unsigned int>();
-            break;
+            for (std::size_t y = 0; y < size[1]; y++)
+            {
+                const TPixel* p = in + static_cast<long long>(z) * step[2] + static_cast<long long>(y) * step[1];
+                TOutputPixel* row = out;
+                for (std::size_t x = 0; x < size[0]; x++, p += step[0])
+                    *out++ = convert(*p);
+                if (sliceMinimum)
+                    MergePixelRange(row, size[0], sliceMinimum[z], sliceMaximum[z]);
+            }
         }
-        case itk::ImageIOBase::INT:
+    }
+    else
+    {
+        // Axis b of the output is transposed with the first axis, axis c
+        // is walked outside the tiles.
+        const unsigned int b = TUnitAxis;
+        const unsigned int c = 3 - TUnitAxis;
+        const std::size_t outStride[3] = { 1, size[0], sliceSize };
+        TOutputPixel buffer[tile * tile];
+        for (std::size_t k = 0; k < size[c]; k++)
         {
-            ret=InternalFilter<int>();
-            break;
+            const TPixel* inPlane = in + static_cast<long long>(k) * step[c];
+            TOutputPixel* outPlane = out + k * outStride[c];
+            for (std::size_t j0 = 0; j0 < size[b]; j0 += tile)
+            {
+                const std::size_t j1 = j0 + tile < size[b] ? j0 + tile : size[b];
+                for (std::size_t i0 = 0; i0 < size[0]; i0 += tile)
+                {
+                    const std::size_t i1 = i0 + tile < size[0] ? i0 + tile : size[0];
+                    // The tile is read along the first axis of the input
+                    // into a buffer, then written along the first axis of
+                    // the output.
+                    for (std::size_t i = i0; i < i1; i++)
+                    {
+                        const TPixel* p = inPlane + static_cast<long long>(i) * step[0] + static_cast<long long>(j0) * step[b];
+                        for (std::size_t j = j0; j < j1; j++, p += step[b])
+                            buffer[(j - j0) * tile + (i - i0)] = convert(*p);
+                    }
+                    for (std::size_t j = j0; j < j1; j++)
+                    {
+                        const TOutputPixel* p = buffer + (j - j0) * tile;
+                        TOutputPixel* q = outPlane + j * outStride[b] + i0;
+                        if (sliceMinimum)
+                        {
+                            // The slice is j if the transposed axis is
+                            // the third one, k otherwise
+                            const std::size_t z = b == 2 ? j : k;
+                            MergePixelRange(p, i1 - i0, sliceMinimum[z], sliceMaximum[z]);
+                        }
+                        for (std::size_t i = i0; i < i1; i++)
+                            *q++ = *p++;
+                    }
+                }
+            }
         }
-        case itk::ImageIOBase::ULONG:
-        {
-            ret=InternalFilter<unsigned long>();
+    }
+}
+
+
+/*!
+ * \brief Copies the pixels of a reoriented image, with the kernel for the
+ * axis of the output that is the first axis of the input.
+ */
+template<class TPixel, class TOutputPixel, class TConvert>
+static void CopyReorientedPixels(unsigned int unitAxis, const TPixel* in, TOutputPixel* out, const std::size_t size[3], const long long step[3], const TConvert& convert,
+                                 double* sliceMinimum, double* sliceMaximum)
+{
+    switch(unitAxis)
+    {
+        case 0:
+            CopyReorientedPixels<0>(in, out, size, step, convert, sliceMinimum, sliceMaximum);
             break;
-        }
-        case itk::ImageIOBase::LONG:
-        {
-            ret=InternalFilter<long>();
+        case 1:
+            CopyReorientedPixels<1>(in, out, size, step, convert, sliceMinimum, sliceMaximum);
             break;
-        }
-        case itk::ImageIOBase::FLOAT:
-        {
-            ret=InternalFilter<float>();
+        default:
+            CopyReorientedPixels<2>(in, out, size, step, convert, sliceMinimum, sliceMaximum);
             break;
-        }
-        case itk::ImageIOBase::DOUBLE:
+    }
+}
+
+
+bool InputFilter::Filter( void )
+{
+
+#ifdef DEBUG
+    std::cout << "InputFilter - BEGIN" << std::endl;
+    std::cout << "InputFilter::m_InputImage directions:" << std::endl;
+    std::cout << m_InputImage->GetDirection() << std::endl;
+#endif // DEBUG
+
+    bool ret=false;
+
+    if (m_InputImage->GetNumberOfComponentsPerPixel() > 1)
+    {
+        // RGB and RGBA images (see n2d::InputImporter)
+        switch(m_InputPixelType)
         {
-            ret=InternalFilter<double>();
-            break;
+            case itk::ImageIOBase::UCHAR:
+            {
+                ret=InternalFilterColor<unsigned char>();
+                break;
+            }
+            case itk::ImageIOBase::USHORT:
+            {
+                ret=InternalFilterColor<unsigned short>();
+                break;
+            }
+            case itk::ImageIOBase::FLOAT:
+            {
+                ret=InternalFilterColor<float>();
+                break;
+            }
+            case itk::ImageIOBase::DOUBLE:
+            {
+                ret=InternalFilterColor<double>();
+                break;
+            }
+            default:
+            {
+                std::cerr<<"ERROR: Unknown color component type"<<std::endl;
+                return false;
+            }
         }
-        default:
+    }
+    else
+    {
+        switch(m_InputPixelType)
         {
-            std::cerr<<"ERROR: Unknown pixel type"<<std::endl;
-            return false;
+            case itk::ImageIOBase::UCHAR:
+            {
+                ret=InternalFilter<unsigned char>();
+                break;
+            }
+            case itk::ImageIOBase::CHAR:
+            {
+                ret=InternalFilter<char>();
+                break;
+            }
+            case itk::ImageIOBase::USHORT:
+            {
+                ret=InternalFilter<unsigned short>();
+                break;
+            }
+            case itk::ImageIOBase::SHORT:
+            {
+                ret=InternalFilter<short>();
+                break;
+            }
+            case itk::ImageIOBase::UINT:
+            {
+                ret=InternalFilter<unsigned int>();
+                break;
+            }
+            case itk::ImageIOBase::INT:
+            {
+                ret=InternalFilter<int>();
+                break;
+            }
+            case itk::ImageIOBase::ULONG:
+            {
+                ret=InternalFilter<unsigned long>();
+                break;
+            }
+            case itk::ImageIOBase::LONG:
+            {
+                ret=InternalFilter<long>();
+                break;
+            }
+            case itk::ImageIOBase::FLOAT:
+            {
+                ret=InternalFilter<float>();
+                break;
+            }
+            case itk::ImageIOBase::DOUBLE:
+            {
+                ret=InternalFilter<double>();
+                break;
+            }
+            default:
+            {
+                std::cerr<<"ERROR: Unknown pixel type"<<std::endl;
+                return false;
+            }
         }
-   }
+    }
 
 #ifdef DEBUG
     std::cout << "InputFilter - END" << std::endl;
@@ -143,14 +477,10 @@ template<class TPixel> bool InputFilter::InternalFilter(void)
     //BEGIN Typedefs
     typedef itk::Image<TPixel, Dimension>      InternalImageType;
     typedef itk::OrientImageFilter<InternalImageType,InternalImageType> OrienterType;
-    typedef itk::RescaleIntensityImageFilter<InternalImageType, DICOM3DImageType > RescaleType;
-    typedef itk::CastImageFilter < InternalImageType, DICOM3DImageType > CastType;
     //END Typedefs
 
     //BEGIN declarations
     typename OrienterType::Pointer orienter;
-    typename RescaleType::Pointer rescaleFilter;
-    typename CastType::Pointer cast;
     //END declarations
 
     typename InternalImageType::ConstPointer internalImage;
@@ -218,9 +548,16 @@ template<class TPixel> bool InputFilter::InternalFilter(void)
         { "ASL", itk::SpatialOrientation::ITK_COORDINATE_ORIENTATION_ASL}
     };
 
+    // Reorienting only permutes and flips the axes, when the permutation is
+    // known this is done while converting the pixels (see ReorientAndConvert),
+    // without a reoriented copy of the image.
+    Reorientation reorientation;
+    const bool permuted = m_FiltersArgs.reorient != std::string("NO_REORIENT") &&
+                          GetReorientation(internalImage->GetDirection(), m_FiltersArgs.reorient, reorientation);
+
     //original code
     //#ifndef NO_REORIENT
-    if (m_FiltersArgs.reorient != std::string("NO_REORIENT"))
+    if (m_FiltersArgs.reorient != std::string("NO_REORIENT") && !permuted)
     {
 
         orienter = OrienterType::New();
@@ -260,67 +597,213 @@ template<class TPixel> bool InputFilter::InternalFilter(void)
 
 
 
+    typename InternalImageType::ConstPointer orientedImage;
+    if (orienter.IsNull())
+        orientedImage = internalImage;
+    else
+        orientedImage = orienter->GetOutput();
+
+
+
+    //BEGIN Resampling
+    // The grid is that of the reoriented image, so the resampled image is
+    // already reoriented and no reoriented copy is made.
+    if (m_FiltersArgs.resample != "none")
+    {
+        typename InternalImageType::Pointer resampledImage;
+        if (!Resample<TPixel>(orientedImage, reorientation, resampledImage))
+            return false;
+        orientedImage = resampledImage;
+        reorientation = Reorientation();
+    }
+    //END Resampling
+
+
+
+    //BEGIN Statistics
+    // Computed once for the output pixel type, the rescaling and the
+    // window, the values do not depend on the orientation. With an explicit
+    // output type that does not hold every value of the input pixel type,
+    // they tell whether values are clamped (see CastPixel).
+    PixelType explicitPixelType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+    bool exact;
+    if (!m_FiltersArgs.rescale && m_FiltersArgs.outputtype != "auto" &&
+        !PlanOutputPixelType(m_FiltersArgs, m_InputPixelType, explicitPixelType, exact))
+        return false;
+    double explicitMinimum = 0.0;
+    double explicitMaximum = 0.0;
+    const bool checkRange = explicitPixelType != itk::ImageIOBase::UNKNOWNCOMPONENTTYPE &&
+                            !OutputPixelTypeFits<TPixel>(explicitPixelType, explicitMinimum, explicitMaximum);
+
+    tools::ImageStatistics statistics;
+    if (m_FiltersArgs.rescale || m_FiltersArgs.outputtype == "auto" || m_FiltersArgs.window || checkRange)
+    {
+        std::cout << " * \033[1;34mComputing statistics\033[0m... " << std::endl;
+        statistics.Compute(orientedImage->GetBufferPointer(), orientedImage->GetBufferedRegion().GetNumberOfPixels());
+        std::cout << " * \033[1;34mComputing statistics\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+    }
+    //END Statistics
+
+
+
+    //BEGIN Output pixel type
+
     if (m_FiltersArgs.rescale)
     {
-        //BEGIN Rescale
-        rescaleFilter = RescaleType::New();
+        // Rescaled values are integers in [rescaleminimum, rescalemaximum]
+        if (!SelectOutputPixelType(rescaleminimum, rescalemaximum, true))
+            return false;
+    }
+    else if (m_FiltersArgs.outputtype == "auto")
+    {
+        if (!SelectOutputPixelType(statistics.GetMinimum(), statistics.GetMaximum(), statistics.IsIntegral()))
+            return false;
+    }
+    else if (!SelectOutputPixelType(0, 0, true))
+    {
+        return false;
+    }
 
-        //original code
-        //#ifdef NO_REORIENT
+    if (checkRange && (statistics.GetMinimum() < explicitMinimum || statistics.GetMaximum() > explicitMaximum))
+        std::cerr << "WARNING: Image range [" << statistics.GetMinimum() << ", " << statistics.GetMaximum() << "] does not fit "
+                  << m_FiltersArgs.outputtype << ", values will be clamped to [" << explicitMinimum << ", " << explicitMaximum << "]." << std::endl;
+    //END Output pixel type
 
-        if (m_FiltersArgs.reorient == "NO_REORIENT")
-        {
-            rescaleFilter->SetInput(internalImage);
-        }
-        //#else
-        else
-        {
-            rescaleFilter->SetInput(orienter->GetOutput());
-        }
-        //#endif
+    if (m_FiltersArgs.window)
+        SetWindowTags(statistics);
 
-        rescaleFilter->SetOutputMinimum( 0 );
-        rescaleFilter->SetOutputMaximum( (2^11)-1 );
 
-        try
-        {
-            std::cout << " * \033[1;34mRescaling\033[0m... " << std::endl;
-            rescaleFilter->Update();
-            std::cout << " * \033[1;34mRescaling\033[0m... \033[1;32mDONE\033[0m" << std::endl;
-        }
-        catch ( itk::ExceptionObject & ex )
+
+    switch(m_OutputPixelType)
+    {
+        case itk::ImageIOBase::UCHAR:
+            return InternalConvert<TPixel, unsigned char>(orientedImage, reorientation, statistics);
+        case itk::ImageIOBase::USHORT:
+            return InternalConvert<TPixel, unsigned short>(orientedImage, reorientation, statistics);
+        case itk::ImageIOBase::SHORT:
+            return InternalConvert<TPixel, signed short>(orientedImage, reorientation, statistics);
+        case itk::ImageIOBase::UINT:
+            return InternalConvert<TPixel, unsigned int>(orientedImage, reorientation, statistics);
+        default:
         {
-            std::cout << " * \033[1;34mRescaling\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
-            std::string message;
-            message = ex.GetLocation();
-            message += "\n";
-            message += ex.GetDescription();
-            std::cerr << message << std::endl;
-            return true;
+            std::cerr<<"ERROR: Unknown output pixel type"<<std::endl;
+            return false;
         }
+    }
+}
 
-        m_FilteredImage =rescaleFilter->GetOutput();
-        //END Rescale
+
+
+template<class TComponent> bool InputFilter::InternalFilterColor(void)
+{
+    if (m_FiltersArgs.rescale || m_FiltersArgs.resample != "none")
+    {
+        std::cerr << "ERROR: Color images cannot be rescaled or resampled" << std::endl;
+        return false;
     }
-    else
+
+    // The pixel tags are set by n2d::ColorExporter
+    m_OutputPixelType = itk::ImageIOBase::UCHAR;
+
+    if (m_InputImage->GetNumberOfComponentsPerPixel() == 3)
+        return ConvertColor< itk::RGBPixel<TComponent> >();
+    return ConvertColor< itk::RGBAPixel<TComponent> >();
+}
+
+
+
+template<class TPixel> bool InputFilter::ConvertColor(void)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>      InternalImageType;
+    typedef typename TPixel::ComponentType     ComponentType;
+    //END Typedefs
+
+    typename InternalImageType::ConstPointer internalImage;
+    internalImage = dynamic_cast< const InternalImageType* >(m_InputImage.GetPointer());
+    if(!internalImage)
     {
-        //BEGIN Cast
-        // Caster
-        cast = CastType::New();
+        std::cerr<<"Error Null Pointer In Filter"<<std::endl;
+        return false;
+    }
 
-        //original code
-        //#ifdef NO_REORIENT
+    // Only permutations and flips, done while converting the pixels
+    Reorientation reorientation;
+    if (m_FiltersArgs.reorient != std::string("NO_REORIENT") &&
+        !GetReorientation(internalImage->GetDirection(), m_FiltersArgs.reorient, reorientation))
+    {
+        std::cerr << "ERROR: Cannot reorient the color image to " << m_FiltersArgs.reorient << std::endl;
+        return false;
+    }
 
-        if (m_FiltersArgs.reorient == "NO_REORIENT")
-        {
-            cast->SetInput(internalImage);
-        }
-        //#else
-        else
+    //BEGIN Color range
+    // 8 bits components are kept, the others are scaled so that the
+    // largest color component is 255 and the largest alpha is opaque. The
+    // image is then the whole volume (see InputImporter::canReadSliceRange()),
+    // so all the slice ranges of a series get the same scale.
+    const unsigned int components = TPixel::Dimension;
+    double factor = 1.0;
+    double alphaFactor = 1.0 / 255.0;
+    if (sizeof(ComponentType) != 1)
+    {
+        const ComponentType* p = reinterpret_cast<const ComponentType*>(internalImage->GetBufferPointer());
+        const std::size_t count = internalImage->GetBufferedRegion().GetNumberOfPixels();
+        double maximum = 0.0;
+        double alphaMaximum = 0.0;
+        for (std::size_t i = 0; i < count; i++, p += components)
         {
-            cast->SetInput(orienter->GetOutput());
+            for (unsigned int c = 0; c < 3; c++)
+                maximum = p[c] > maximum ? p[c] : maximum;
+            if (components > 3)
+                alphaMaximum = p[components - 1] > alphaMaximum ? p[components - 1] : alphaMaximum;
         }
-        //#endif
+        factor = maximum > 0.0 ? 255.0 / maximum : 0.0;
+        alphaFactor = alphaMaximum > 0.0 ? 1.0 / alphaMaximum : 0.0;
+    }
+    //END Color range
+
+    const std::string task = !reorientation.IsIdentity() ? "Orienting" : "Converting";
+    std::cout << " * \033[1;34m" << task << "\033[0m... " << std::endl;
+    if (!ReorientPixels<TPixel, ColorPixelType>(internalImage, reorientation, ColorPixel<TPixel>(factor, alphaFactor), task, false))
+        return false;
+    std::cout << " * \033[1;34m" << task << "\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+
+    if ((m_FiltersArgs.slicestart != 0 || m_FiltersArgs.sliceend != 0) && !ExtractSlices<ColorPixelType>())
+        return false;
+
+    if (m_FiltersArgs.crop)
+    {
+        // Background is black
+        ColorPixelType background;
+        background.Fill(0);
+        return CropToContent<ColorPixelType>(background);
+    }
+    return true;
+}
+
+
+
+template<class TPixel, class TOutputPixel> bool InputFilter::InternalConvert(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const tools::ImageStatistics& statistics)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>       InternalImageType;
+    typedef itk::Image<TOutputPixel, Dimension> OutputImageType;
+    typedef itk::CastImageFilter<InternalImageType, OutputImageType> CastType;
+    //END Typedefs
+
+    SetPixelRepresentationTags();
+
+    // itk::CastImageFilter does not clamp the values that do not fit
+    if (!reorientation.IsIdentity() || m_FiltersArgs.rescale || m_FiltersArgs.slicepixelrange || !PixelTypeFits<TPixel, TOutputPixel>())
+    {
+        if (!ReorientAndConvert<TPixel, TOutputPixel>(image, reorientation, statistics))
+            return false;
+    }
+    else
+    {
+        //BEGIN Cast
+        typename CastType::Pointer cast = CastType::New();
+        cast->SetInput(image);
 
         try
         {
@@ -341,22 +824,635 @@ template<class TPixel> bool InputFilter::InternalFilter(void)
         m_FilteredImage = cast->GetOutput();
         //END Cast
     }
+
+    if ((m_FiltersArgs.slicestart != 0 || m_FiltersArgs.sliceend != 0) && !ExtractSlices<TOutputPixel>())
+        return false;
+
+    if (m_FiltersArgs.crop)
+    {
+        // Background is the converted value of 0
+        TOutputPixel background = itk::NumericTraits<TOutputPixel>::ZeroValue();
+        if (m_FiltersArgs.rescale)
+        {
+            double factor;
+            double offset;
+            GetRescaleTransform(statistics, m_FiltersArgs.rescalelow, m_FiltersArgs.rescalehigh, factor, offset);
+            background = RescalePixel<double, TOutputPixel>(factor, offset, rescaleminimum, rescalemaximum)(0.0);
+        }
+        return CropToContent<TOutputPixel>(background);
+    }
     return true;
 }
 
 
 
-} // namespace n2d
+template<class TPixel, class TOutputPixel> bool InputFilter::ReorientAndConvert(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const tools::ImageStatistics& statistics)
+{
+    const std::string task = !reorientation.IsIdentity() ? "Orienting" : (m_FiltersArgs.rescale ? "Rescaling" : "Converting");
+    std::cout << " * \033[1;34m" << task << "\033[0m... " << std::endl;
+
+    // (0028,0106) and (0028,0107) are US or SS
+    const bool pixelRange = m_FiltersArgs.slicepixelrange && sizeof(TOutputPixel) <= 2;
+
+    // Rescaling with the range of the statistics, or a cast
+    bool ret;
+    if (m_FiltersArgs.rescale)
+    {
+        double factor;
+        double offset;
+        GetRescaleTransform(statistics, m_FiltersArgs.rescalelow, m_FiltersArgs.rescalehigh, factor, offset);
+        ret = ReorientPixels<TPixel, TOutputPixel>(image, reorientation, RescalePixel<TPixel, TOutputPixel>(factor, offset, rescaleminimum, rescalemaximum), task, pixelRange);
+    }
+    else
+    {
+        ret = ReorientPixels<TPixel, TOutputPixel>(image, reorientation, CastPixel<TPixel, TOutputPixel>(), task, pixelRange);
+    }
+    if (!ret)
+        return false;
+
+    std::cout << " * \033[1;34m" << task << "\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+    return true;
+}
+
+
+
+template<class TPixel, class TOutputPixel, class TConvert>
+bool InputFilter::ReorientPixels(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const TConvert& convert,
+                                 const std::string& task, bool pixelRange)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>       InternalImageType;
+    typedef itk::Image<TOutputPixel, Dimension> OutputImageType;
+    //END Typedefs
+
+    //BEGIN Geometry
+    typename OutputImageType::RegionType region;
+    typename OutputImageType::SpacingType spacing;
+    typename OutputImageType::PointType origin;
+    typename OutputImageType::DirectionType direction;
+    GetReorientedGeometry(image, reorientation, region, spacing, origin, direction);
+    const typename OutputImageType::SizeType size = region.GetSize();
+
+    // Offsets in the input buffer along each axis of the output
+    const typename InternalImageType::SizeType inputSize = image->GetBufferedRegion().GetSize();
+    long long stride[Dimension];
+    long long step[Dimension];
+    long long first = 0;
+    for (unsigned int i = 0; i < Dimension; i++)
+        stride[i] = i == 0 ? 1 : stride[i - 1] * static_cast<long long>(inputSize[i - 1]);
+    for (unsigned int k = 0; k < Dimension; k++)
+    {
+        const unsigned int axis = reorientation.order[k];
+        step[k] = reorientation.flip[k] ? -stride[axis] : stride[axis];
+        if (reorientation.flip[k])
+            first += (static_cast<long long>(inputSize[axis]) - 1) * stride[axis];
+    }
+
+    typename OutputImageType::Pointer output = OutputImageType::New();
+    output->SetRegions(region);
+    output->SetSpacing(spacing);
+    output->SetOrigin(origin);
+    output->SetDirection(direction);
+    try
+    {
+        output->Allocate();
+    }
+    catch ( itk::ExceptionObject & ex )
+    {
+        std::cout << " * \033[1;34m" << task << "\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::string message;
+        message = ex.GetLocation();
+        message += "\n";
+        message += ex.GetDescription();
+        std::cerr << message << std::endl;
+        return false;
+    }
+    //END Geometry
+
+    //BEGIN Pixels
+    // Axis of the output along which the input is contiguous
+    unsigned int unitAxis = 0;
+    for (unsigned int k = 0; k < Dimension; k++)
+        if (reorientation.order[k] == 0)
+            unitAxis = k;
+
+    const TPixel* in = image->GetBufferPointer() + first;
+    TOutputPixel* out = output->GetBufferPointer();
+    const std::size_t outputSize[Dimension] = { size[0], size[1], size[2] };
+
+    m_SliceMinimum.clear();
+    m_SliceMaximum.clear();
+    double* sliceMinimum = NULL;
+    double* sliceMaximum = NULL;
+    if (pixelRange)
+    {
+        m_SliceMinimum.assign(size[2], itk::NumericTraits<double>::max());
+        m_SliceMaximum.assign(size[2], itk::NumericTraits<double>::NonpositiveMin());
+        sliceMinimum = &m_SliceMinimum[0];
+        sliceMaximum = &m_SliceMaximum[0];
+    }
+
+    CopyReorientedPixels(unitAxis, in, out, outputSize, step, convert, sliceMinimum, sliceMaximum);
+    //END Pixels
+
+    m_FilteredImage = output;
+    return true;
+}
+
 
 
+void InputFilter::GetReorientedGeometry(const ImageType* image, const Reorientation& reorientation, ImageType::RegionType& region,
+                                        ImageType::SpacingType& spacing, ImageType::PointType& origin, ImageType::DirectionType& direction)
+{
+    // Axis k of the output is axis order[k] of the input, as
+    // itk::PermuteAxesImageFilter and itk::FlipImageFilter (not flipping
+    // about the origin) compute it: each pixel keeps its physical position.
+    const ImageType::RegionType inputRegion = image->GetBufferedRegion();
+    const ImageType::SizeType inputSize = inputRegion.GetSize();
+    const ImageType::SpacingType inputSpacing = image->GetSpacing();
+    const ImageType::DirectionType inputDirection = image->GetDirection();
+
+    if (reorientation.IsIdentity())
+    {
+        // Keeps the index of the slices read by n2d::InputImporter
+        region = inputRegion;
+        spacing = inputSpacing;
+        origin = image->GetOrigin();
+        direction = inputDirection;
+        return;
+    }
+
+    ImageType::SizeType size;
+    ImageType::IndexType corner = inputRegion.GetIndex();
+    for (unsigned int k = 0; k < Dimension; k++)
+    {
+        const unsigned int axis = reorientation.order[k];
+        const double sign = reorientation.flip[k] ? -1.0 : 1.0;
+        size[k] = inputSize[axis];
+        spacing[k] = inputSpacing[axis];
+        for (unsigned int j = 0; j < Dimension; j++)
+            direction[j][k] = sign * inputDirection[j][axis];
+        if (reorientation.flip[k])
+            corner[axis] += inputSize[axis] - 1;
+    }
+    image->TransformIndexToPhysicalPoint(corner, origin);
+
+    region = ImageType::RegionType();
+    region.SetSize(size);
+}
+
+
+
+bool InputFilter::GetReorientation(const ImageType::DirectionType& direction, const std::string& orientation, Reorientation& reorientation)
+{
+    // Letters are the side each axis comes from, as in
+    // itk::SpatialOrientation: the identity direction is "RAI".
+    static const char fromLetter[Dimension] = { 'R', 'A', 'I' };
+    static const char toLetter[Dimension]   = { 'L', 'P', 'S' };
+
+    if (orientation.size() != Dimension)
+        return false;
+
+    // Anatomical axis closest to each axis of the image
+    unsigned int anatomical[Dimension];
+    char letter[Dimension];
+    for (unsigned int i = 0; i < Dimension; i++)
+    {
+        anatomical[i] = 0;
+        for (unsigned int j = 1; j < Dimension; j++)
+            if (std::fabs(direction[j][i]) > std::fabs(direction[anatomical[i]][i]))
+                anatomical[i] = j;
+        letter[i] = direction[anatomical[i]][i] > 0 ? fromLetter[anatomical[i]] : toLetter[anatomical[i]];
+    }
+
+    bool used[Dimension] = { false, false, false };
+    for (unsigned int k = 0; k < Dimension; k++)
+    {
+        unsigned int desired = Dimension;
+        for (unsigned int j = 0; j < Dimension; j++)
+            if (orientation[k] == fromLetter[j] || orientation[k] == toLetter[j])
+                desired = j;
+
+        unsigned int axis = Dimension;
+        for (unsigned int i = 0; i < Dimension; i++)
+            if (anatomical[i] == desired && !used[i])
+                axis = i;
+        // Unknown orientation, or oblique image with two axes closest to
+        // the same anatomical axis
+        if (axis == Dimension)
+            return false;
+
+        used[axis] = true;
+        reorientation.order[k] = axis;
+        reorientation.flip[k] = (letter[axis] != orientation[k]);
+    }
+    return true;
+}
+
+
+
+template<class TPixel> bool InputFilter::Resample(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation,
+                                                   typename itk::Image<TPixel, Dimension>::Pointer& resampled)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>                                          InternalImageType;
+    typedef itk::ResampleImageFilter<InternalImageType, InternalImageType>         ResampleType;
+    typedef itk::InterpolateImageFunction<InternalImageType, double>               InterpolatorType;
+    typedef itk::LinearInterpolateImageFunction<InternalImageType, double>         LinearInterpolatorType;
+    typedef itk::NearestNeighborInterpolateImageFunction<InternalImageType, double> NearestInterpolatorType;
+    typedef itk::BSplineInterpolateImageFunction<InternalImageType, double, double> BSplineInterpolatorType;
+    //END Typedefs
+
+    //BEGIN Grid
+    ImageType::RegionType region;
+    ImageType::SpacingType spacing;
+    ImageType::PointType origin;
+    ImageType::DirectionType direction;
+    GetReorientedGeometry(image, reorientation, region, spacing, origin, direction);
+
+    unsigned long long size[Dimension];
+    double spacingValues[Dimension];
+    unsigned long long resampledSize[Dimension];
+    double resampledSpacing[Dimension];
+    for (unsigned int k = 0; k < Dimension; k++)
+    {
+        size[k] = region.GetSize()[k];
+        spacingValues[k] = spacing[k];
+    }
+    tools::GetResampledGrid(m_FiltersArgs.resample, m_FiltersArgs.resamplevalues, size, spacingValues, resampledSize, resampledSpacing);
+
+    // The first voxel is moved so that the resampled image covers the same
+    // extent: the outer edges of the first and of the last voxels are kept.
+    typename ResampleType::SizeType outputSize;
+    typename ResampleType::SpacingType outputSpacing;
+    typename ResampleType::OriginPointType outputOrigin = origin;
+    for (unsigned int k = 0; k < Dimension; k++)
+    {
+        outputSize[k] = resampledSize[k];
+        outputSpacing[k] = resampledSpacing[k];
+        const double shift = region.GetIndex()[k] * spacing[k] + (resampledSpacing[k] - spacing[k]) / 2;
+        for (unsigned int j = 0; j < Dimension; j++)
+            outputOrigin[j] += direction[j][k] * shift;
+    }
+    //END Grid
+
+    typename InterpolatorType::Pointer interpolator;
+    if (m_FiltersArgs.interpolation == "nearest")
+        interpolator = NearestInterpolatorType::New();
+    else if (m_FiltersArgs.interpolation == "bspline")
+        interpolator = BSplineInterpolatorType::New();
+    else
+        interpolator = LinearInterpolatorType::New();
+
+    typename ResampleType::Pointer resample = ResampleType::New();
+    resample->SetInput(image);
+    resample->SetInterpolator(interpolator);
+    resample->SetSize(outputSize);
+    resample->SetOutputSpacing(outputSpacing);
+    resample->SetOutputOrigin(outputOrigin);
+    resample->SetOutputDirection(direction);
+    resample->SetDefaultPixelValue(itk::NumericTraits<TPixel>::ZeroValue());
+
+    try
+    {
+        std::cout << " * \033[1;34mResampling\033[0m... " << std::endl;
+        resample->Update();
+        std::cout << " * \033[1;34mResampling\033[0m... \033[1;32mDONE\033[0m ("
+                  << outputSize[0] << "x" << outputSize[1] << "x" << outputSize[2] << ")" << std::endl;
+    }
+    catch ( itk::ExceptionObject & ex )
+    {
+        std::cout << " * \033[1;34mResampling\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::string message;
+        message = ex.GetLocation();
+        message += "\n";
+        message += ex.GetDescription();
+        std::cerr << message << std::endl;
+        return false;
+    }
+
+    resampled = resample->GetOutput();
+    resampled->DisconnectPipeline();
+    return true;
+}
+
+
+
+template<class TOutputPixel> bool InputFilter::ExtractSlices(void)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TOutputPixel, Dimension> OutputImageType;
+    //END Typedefs
+
+    typename OutputImageType::ConstPointer image = dynamic_cast<const OutputImageType*>(m_FilteredImage.GetPointer());
+    if(!image)
+    {
+        std::cerr<<"Error Null Pointer In Filter"<<std::endl;
+        return false;
+    }
+
+    typename OutputImageType::RegionType region;
+    if (!tools::GetSliceRegion(image.GetPointer(), m_FiltersArgs.slicestart, m_FiltersArgs.sliceend, region))
+    {
+        std::cerr << "ERROR: The slice range is outside the image." << std::endl;
+        return false;
+    }
+
+    // Already read by n2d::InputImporter
+    if (region == image->GetLargestPossibleRegion())
+        return true;
+
+    return ExtractRegion<TOutputPixel>(region, "Extracting slices");
+}
 
 
-//TODO set correctly BITS ALLOCATED (0028,0100)/ BITS STORED (0028,0101) / HIGH BIT (0028,0102)
-// (at the moment it looks impossible to do this using itk+gdcm)
-//        // Bits Allocated
-//          itk::EncapsulateMetaData<std::string>( inputDict, "0028|0100", "16");
-//        // Bits Stored
-//          itk::EncapsulateMetaData<std::string>( inputDict, "0028|0101", "12");
-//        // High Bit
-//          itk::EncapsulateMetaData<std::string>( inputDict, "0028|0102", "11");
 
+template<class TOutputPixel> bool InputFilter::CropToContent(TOutputPixel background)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TOutputPixel, Dimension> OutputImageType;
+    //END Typedefs
+
+    typename OutputImageType::ConstPointer image = dynamic_cast<const OutputImageType*>(m_FilteredImage.GetPointer());
+    if(!image)
+    {
+        std::cerr<<"Error Null Pointer In Filter"<<std::endl;
+        return false;
+    }
+
+    typename OutputImageType::RegionType region;
+    if (!tools::GetContentRegion(image.GetPointer(), background, m_FiltersArgs.cropmargin, region))
+    {
+        std::cout << " * \033[1;34mCropping\033[0m: the image has no content, it is not cropped" << std::endl;
+        return true;
+    }
+    if (region == image->GetBufferedRegion())
+        return true;
+
+    if (!ExtractRegion<TOutputPixel>(region, "Cropping"))
+        return false;
+    std::cout << "   " << region.GetSize()[0] << "x" << region.GetSize()[1] << "x" << region.GetSize()[2] << " from index "
+              << region.GetIndex()[0] << "," << region.GetIndex()[1] << "," << region.GetIndex()[2] << std::endl;
+    return true;
+}
+
+
+
+template<class TOutputPixel> bool InputFilter::ExtractRegion(const ImageType::RegionType& region, const std::string& task)
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TOutputPixel, Dimension> OutputImageType;
+    typedef itk::ExtractImageFilter<OutputImageType, OutputImageType> ExtractType;
+    //END Typedefs
+
+    typename OutputImageType::ConstPointer image = dynamic_cast<const OutputImageType*>(m_FilteredImage.GetPointer());
+    if(!image)
+    {
+        std::cerr<<"Error Null Pointer In Filter"<<std::endl;
+        return false;
+    }
+
+    typename ExtractType::Pointer extract = ExtractType::New();
+    extract->SetInput(image);
+    extract->SetExtractionRegion(region);
+    extract->SetDirectionCollapseToSubmatrix();
+
+    try
+    {
+        std::cout << " * \033[1;34m" << task << "\033[0m... " << std::endl;
+        extract->Update();
+        std::cout << " * \033[1;34m" << task << "\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+    }
+    catch ( itk::ExceptionObject & ex )
+    {
+        std::cout << " * \033[1;34m" << task << "\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::string message;
+        message = ex.GetLocation();
+        message += "\n";
+        message += ex.GetDescription();
+        std::cerr << message << std::endl;
+        return false;
+    }
+    m_FilteredImage = extract->GetOutput();
+
+    //BEGIN Slice ranges
+    if (!m_SliceMinimum.empty())
+    {
+        // The slice ranges follow the slices that are kept
+        const ImageType::RegionType previous = image->GetLargestPossibleRegion();
+        const std::size_t first = region.GetIndex()[2] - previous.GetIndex()[2];
+        const std::size_t last = first + region.GetSize()[2];
+        m_SliceMinimum = std::vector<double>(m_SliceMinimum.begin() + first, m_SliceMinimum.begin() + last);
+        m_SliceMaximum = std::vector<double>(m_SliceMaximum.begin() + first, m_SliceMaximum.begin() + last);
+
+        // Cropped slices may have lost their smallest or largest value
+        if (region.GetSize()[0] != previous.GetSize()[0] || region.GetSize()[1] != previous.GetSize()[1])
+        {
+            const OutputImageType* cropped = static_cast<const OutputImageType*>(m_FilteredImage.GetPointer());
+            const TOutputPixel* row = cropped->GetBufferPointer();
+            for (std::size_t z = 0; z < m_SliceMinimum.size(); z++)
+            {
+                m_SliceMinimum[z] = itk::NumericTraits<double>::max();
+                m_SliceMaximum[z] = itk::NumericTraits<double>::NonpositiveMin();
+                for (std::size_t y = 0; y < region.GetSize()[1]; y++, row += region.GetSize()[0])
+                    MergePixelRange(row, region.GetSize()[0], m_SliceMinimum[z], m_SliceMaximum[z]);
+            }
+        }
+    }
+    //END Slice ranges
+
+    return true;
+}
+
+
+
+/*!
+ * \brief Smallest output pixel type holding integers in [minimum, maximum].
+ *
+ * \return UNKNOWNCOMPONENTTYPE if no output pixel type holds the range.
+ */
+static PixelType SmallestOutputPixelType(double minimum, double maximum)
+{
+    if (minimum >= 0 && maximum <= itk::NumericTraits<unsigned char>::max())
+        return itk::ImageIOBase::UCHAR;
+    if (minimum >= 0 && maximum <= itk::NumericTraits<unsigned short>::max())
+        return itk::ImageIOBase::USHORT;
+    if (minimum >= itk::NumericTraits<signed short>::min() && maximum <= itk::NumericTraits<signed short>::max())
+        return itk::ImageIOBase::SHORT;
+    if (minimum >= 0 && maximum <= itk::NumericTraits<unsigned int>::max())
+        return itk::ImageIOBase::UINT;
+    return itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+}
+
+
+
+bool InputFilter::PlanOutputPixelType(const FiltersArgs& filtersArgs, PixelType inputPixelType, PixelType& outputPixelType, bool& exact)
+{
+    exact = true;
+    if (filtersArgs.outputtype == "uint8")
+        outputPixelType = itk::ImageIOBase::UCHAR;
+    else if (filtersArgs.outputtype == "uint16")
+        outputPixelType = itk::ImageIOBase::USHORT;
+    else if (filtersArgs.outputtype == "int16")
+        outputPixelType = itk::ImageIOBase::SHORT;
+    else if (filtersArgs.outputtype == "uint32")
+        outputPixelType = itk::ImageIOBase::UINT;
+    else if (filtersArgs.outputtype != "auto")
+    {
+        std::cerr << "ERROR: Unknown output type \"" << filtersArgs.outputtype << "\"" << std::endl;
+        return false;
+    }
+    else if (filtersArgs.rescale)
+        outputPixelType = SmallestOutputPixelType(rescaleminimum, rescalemaximum);
+    else
+    {
+        // The type depends on the range of the values, the largest one the
+        // input pixel type can lead to is returned.
+        switch(inputPixelType)
+        {
+            case itk::ImageIOBase::UCHAR:
+                outputPixelType = itk::ImageIOBase::UCHAR;
+                break;
+            case itk::ImageIOBase::USHORT:
+                outputPixelType = itk::ImageIOBase::USHORT;
+                exact = false;
+                break;
+            case itk::ImageIOBase::CHAR:
+            case itk::ImageIOBase::SHORT:
+                outputPixelType = itk::ImageIOBase::SHORT;
+                exact = false;
+                break;
+            default:
+                outputPixelType = itk::ImageIOBase::UINT;
+                exact = false;
+                break;
+        }
+    }
+    return true;
+}
+
+
+
+bool InputFilter::SelectOutputPixelType(double minimum, double maximum, bool integral)
+{
+    if (m_FiltersArgs.outputtype == "uint8")
+        m_OutputPixelType = itk::ImageIOBase::UCHAR;
+    else if (m_FiltersArgs.outputtype == "uint16")
+        m_OutputPixelType = itk::ImageIOBase::USHORT;
+    else if (m_FiltersArgs.outputtype == "int16")
+        m_OutputPixelType = itk::ImageIOBase::SHORT;
+    else if (m_FiltersArgs.outputtype == "uint32")
+        m_OutputPixelType = itk::ImageIOBase::UINT;
+    else if (m_FiltersArgs.outputtype != "auto")
+    {
+        std::cerr << "ERROR: Unknown output type \"" << m_FiltersArgs.outputtype << "\"" << std::endl;
+        return false;
+    }
+    else if (!integral)
+    {
+        std::cerr << "WARNING: Image contains non integer values, they will be truncated to int16." << std::endl;
+        m_OutputPixelType = itk::ImageIOBase::SHORT;
+    }
+    else
+    {
+        m_OutputPixelType = SmallestOutputPixelType(minimum, maximum);
+        if (m_OutputPixelType == itk::ImageIOBase::UNKNOWNCOMPONENTTYPE)
+        {
+            std::cerr << "WARNING: Image range [" << minimum << ", " << maximum << "] does not fit any output type, values will be truncated to int16." << std::endl;
+            m_OutputPixelType = itk::ImageIOBase::SHORT;
+        }
+    }
+
+#ifdef DEBUG
+    std::cout << "InputFilter::m_OutputPixelType: " << itk::ImageIOBase::GetComponentTypeAsString(m_OutputPixelType) << std::endl;
+#endif // DEBUG
+
+    return true;
+}
+
+
+
+void InputFilter::SetPixelRepresentationTags(void)
+{
+    unsigned int bits = 16;
+    unsigned int pixelRepresentation = 0;
+    switch(m_OutputPixelType)
+    {
+        case itk::ImageIOBase::UCHAR:  bits =  8; pixelRepresentation = 0; break;
+        case itk::ImageIOBase::USHORT: bits = 16; pixelRepresentation = 0; break;
+        case itk::ImageIOBase::SHORT:  bits = 16; pixelRepresentation = 1; break;
+        case itk::ImageIOBase::UINT:   bits = 32; pixelRepresentation = 0; break;
+        default: break;
+    }
+
+    // These tags might have been imported from the reference header, so they
+    // are always overwritten. itkGDCMImageIO uses them only when all of them
+    // are set.
+    std::ostringstream value;
+
+//BEGIN (0028,0100) Bits Allocated
+    value.str("");
+    value << bits;
+    itk::EncapsulateMetaData<std::string>(m_Dict, bitsallocatedtag, value.str());
+//END (0028,0100) Bits Allocated
+
+//BEGIN (0028,0101) Bits Stored
+    itk::EncapsulateMetaData<std::string>(m_Dict, bitsstoredtag, value.str());
+//END (0028,0101) Bits Stored
+
+//BEGIN (0028,0102) High Bit
+    value.str("");
+    value << bits - 1;
+    itk::EncapsulateMetaData<std::string>(m_Dict, highbittag, value.str());
+//END (0028,0102) High Bit
+
+//BEGIN (0028,0103) Pixel Representation
+    value.str("");
+    value << pixelRepresentation;
+    itk::EncapsulateMetaData<std::string>(m_Dict, pixelrepresentationtag, value.str());
+//END (0028,0103) Pixel Representation
+}
+
+
+
+void InputFilter::SetWindowTags(const tools::ImageStatistics& statistics)
+{
+    if (!statistics.IsValid())
+        return;
+
+    // Percentiles of the input, converted as the pixels are
+    double factor = 1.0;
+    double offset = 0.0;
+    if (m_FiltersArgs.rescale)
+        GetRescaleTransform(statistics, m_FiltersArgs.rescalelow, m_FiltersArgs.rescalehigh, factor, offset);
+    double low = std::trunc(statistics.GetPercentile(m_FiltersArgs.windowlow) * factor + offset);
+    double high = std::trunc(statistics.GetPercentile(m_FiltersArgs.windowhigh) * factor + offset);
+    if (m_FiltersArgs.rescale)
+    {
+        // Rescaled values are clamped to the output range
+        low = std::max(rescaleminimum, std::min(rescalemaximum, low));
+        high = std::max(rescaleminimum, std::min(rescalemaximum, high));
+    }
+    if (high < low)
+        high = low;
+
+    // Values in [low, high] span the whole display range (see PS3.3 C.11.2.1.2)
+    const double width = high - low + 1;
+    const double center = low + width / 2;
+    std::ostringstream value;
+
+//BEGIN (0028,1050) Window Center
+    value << center;
+    itk::EncapsulateMetaData<std::string>(m_Dict, windowcentertag, value.str());
+//END (0028,1050) Window Center
+
+//BEGIN (0028,1051) Window Width
+    value.str("");
+    value << width;
+    itk::EncapsulateMetaData<std::string>(m_Dict, windowwidthtag, value.str());
+//END (0028,1051) Window Width
+}
+
+
+
+} // namespace n2d
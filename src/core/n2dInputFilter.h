@@ -23,6 +23,9 @@
 #include "n2dDefsImage.h"
 #include "n2dDefsMetadata.h"
 #include "n2dDefsCommandLineArgsStructs.h"
+#include "n2dToolsImageStatistics.h"
+
+#include <vector>
 
 
 namespace n2d {
@@ -34,6 +37,53 @@ namespace n2d {
  * Also handles:
  *
  * \li (0020,0020) Patient Orientation/
+ * \li (0028,0100) Bits Allocated
+ * \li (0028,0101) Bits Stored
+ * \li (0028,0102) High Bit
+ * \li (0028,0103) Pixel Representation
+ * \li (0028,1050) Window Center
+ * \li (0028,1051) Window Width
+ *
+ * The statistics of the values (see tools::ImageStatistics) are computed
+ * once and used for the output pixel type, the rescaling and the window,
+ * which spans the percentiles FiltersArgs::windowlow and
+ * FiltersArgs::windowhigh of the values. The rescaling maps the values
+ * between the percentiles FiltersArgs::rescalelow and
+ * FiltersArgs::rescalehigh onto the output range and clamps the others.
+ *
+ * If FiltersArgs::slicepixelrange is set, the range of the values of each
+ * slice is collected while the pixels are converted (see getSliceMinimum()),
+ * for (0028,0106) and (0028,0107), written by n2d::Instance.
+ *
+ * The output pixel type is either the one requested in FiltersArgs::outputtype
+ * or, when this is "auto", the smallest among uint8, uint16, int16 and uint32
+ * that holds the filtered values losslessly.
+ *
+ * Reorienting (FiltersArgs::reorient) only permutes and flips the axes, it is
+ * done while converting the pixels to the output type, without a reoriented
+ * copy of the input image.
+ *
+ * Resampling (FiltersArgs::resample) is done before the conversion, with
+ * itk::ResampleImageFilter, onto the grid of the reoriented image: when the
+ * reorientation is a permutation the resampled image is already reoriented.
+ * The statistics are those of the resampled image.
+ *
+ * If a slice range is requested (FiltersArgs::slicestart, FiltersArgs::sliceend)
+ * only those slices of the filtered image are kept, the pixel type and the
+ * rescaling are still computed on the whole volume.
+ *
+ * If FiltersArgs::crop is set, the filtered image is then cropped to the
+ * bounding box of the pixels that are not background (the converted value of
+ * 0), grown by FiltersArgs::cropmargin. The index of the cropped region is
+ * kept, so n2d::Instance places the slices and numbers them as in the whole
+ * volume.
+ *
+ * RGB and RGBA images are converted to 8 bits RGB (ColorPixelType) in the
+ * same pass as the reorientation, all the components of a pixel at once:
+ * 8 bits components are kept, the others are scaled to the largest color
+ * component, and the alpha component is composited over black. They can be
+ * reoriented, cropped and restricted to a slice range, but not rescaled or
+ * resampled.
  */
 class InputFilter
 {
@@ -42,6 +92,7 @@ public:
             m_FiltersArgs(filtersArgs),
             m_InputImage(inputImage),
             m_InputPixelType(inputPixelType),
+            m_OutputPixelType(itk::ImageIOBase::SHORT),
             m_Dict(dict)
     {
     }
@@ -57,17 +108,122 @@ public:
  * \return Internal image
  * \sa m_FilteredImage
  */
-    inline DICOM3DImageType::ConstPointer getFilteredImage(void) const { return m_FilteredImage; }
+    inline ImageType::ConstPointer getFilteredImage(void) const { return m_FilteredImage; }
+
+/*!
+ * \brief Get filtered image pixel type.
+ *
+ * \return Filtered image pixel type (UCHAR, USHORT, SHORT or UINT), the
+ * component type (UCHAR) for color images
+ * \sa m_OutputPixelType
+ */
+    inline PixelType getOutputPixelType(void) const { return m_OutputPixelType; }
+
+
+/*!
+ * \brief Get the output pixel type without reading the image.
+ *
+ * When FiltersArgs::outputtype is "auto" and the image is not rescaled, the
+ * type depends on the values of the image: the largest type the input pixel
+ * type can lead to is returned and \c exact is set to false.
+ *
+ * \return false if FiltersArgs::outputtype is not valid.
+ */
+    static bool PlanOutputPixelType(const FiltersArgs& filtersArgs, PixelType inputPixelType, PixelType& outputPixelType, bool& exact);
+
+/*!
+ * \brief Axis permutation and flips that reorient an image.
+ *
+ * Axis \c k of the reoriented image is axis \c order[k] of the image,
+ * reversed if \c flip[k].
+ */
+    struct Reorientation
+    {
+        Reorientation()
+        {
+            for (unsigned int k = 0; k < Dimension; k++)
+            {
+                order[k] = k;
+                flip[k] = false;
+            }
+        }
+
+        bool IsIdentity(void) const
+        {
+            for (unsigned int k = 0; k < Dimension; k++)
+                if (order[k] != k || flip[k])
+                    return false;
+            return true;
+        }
+
+        unsigned int order[Dimension];
+        bool flip[Dimension];
+    };
+
+/*!
+ * \brief Get the reorientation to one of the 48 orientation codes.
+ *
+ * Each axis of the image is matched to the closest anatomical axis, as
+ * itk::OrientImageFilter does.
+ *
+ * \return false if the orientation is not valid or if two axes of the image
+ * are closest to the same anatomical axis.
+ */
+    static bool GetReorientation(const ImageType::DirectionType& direction, const std::string& orientation, Reorientation& reorientation);
+
+/*!
+ * \brief Get the smallest value of each slice of the filtered image.
+ *
+ * \return The values collected while converting the pixels when
+ * FiltersArgs::slicepixelrange is set and the output pixel type is at most
+ * 16 bits, empty otherwise.
+ * \sa getSliceMaximum
+ */
+    inline const std::vector<double>& getSliceMinimum(void) const { return m_SliceMinimum; }
+
+/*!
+ * \brief Get the largest value of each slice of the filtered image.
+ *
+ * \sa getSliceMinimum
+ */
+    inline const std::vector<double>& getSliceMaximum(void) const { return m_SliceMaximum; }
 
 
 private:
     const FiltersArgs& m_FiltersArgs;
     ImageType::ConstPointer m_InputImage;
     PixelType m_InputPixelType;
-    DICOM3DImageType::ConstPointer m_FilteredImage;
+    ImageType::ConstPointer m_FilteredImage;
+    PixelType m_OutputPixelType;
     DictionaryType& m_Dict;
+    std::vector<double> m_SliceMinimum;
+    std::vector<double> m_SliceMaximum;
+
+/*!
+ * \brief Get the geometry of the reoriented image, without reorienting it.
+ *
+ * The region of the image is kept if \c reorientation is the identity,
+ * otherwise its index is 0 and \c origin is the position of its first pixel.
+ */
+    static void GetReorientedGeometry(const ImageType* image, const Reorientation& reorientation, ImageType::RegionType& region,
+                                      ImageType::SpacingType& spacing, ImageType::PointType& origin, ImageType::DirectionType& direction);
 
     template<class TPixel> bool InternalFilter(void);
+    template<class TComponent> bool InternalFilterColor(void);
+    template<class TPixel> bool ConvertColor(void);
+    template<class TPixel, class TOutputPixel> bool InternalConvert(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const tools::ImageStatistics& statistics);
+    template<class TPixel, class TOutputPixel> bool ReorientAndConvert(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const tools::ImageStatistics& statistics);
+    template<class TPixel, class TOutputPixel, class TConvert> bool ReorientPixels(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation, const TConvert& convert,
+                                                                                   const std::string& task, bool pixelRange);
+    template<class TPixel> bool Resample(const itk::Image<TPixel, Dimension>* image, const Reorientation& reorientation,
+                                         typename itk::Image<TPixel, Dimension>::Pointer& resampled);
+    template<class TOutputPixel> bool ExtractSlices(void);
+    template<class TOutputPixel> bool CropToContent(TOutputPixel background);
+    template<class TOutputPixel> bool ExtractRegion(const ImageType::RegionType& region, const std::string& task);
+
+    bool SelectOutputPixelType(double minimum, double maximum, bool integral);
+    void SetPixelRepresentationTags(void);
+    void SetWindowTags(const tools::ImageStatistics& statistics);
 };
 //END class n2d::InputFilter
 
@@ -18,37 +18,113 @@
 
 
 #include "n2dInputImporter.h"
+#include "n2dToolsSliceRange.h"
+
+#include <itkExtractImageFilter.h>
+#include <itkRGBPixel.h>
+#include <itkRGBAPixel.h>
+#include <vnl/vnl_det.h>
 
 
 namespace n2d {
 
-bool InputImporter::Import( void )
+bool InputImporter::ReadImageInformation( void )
 {
-    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO( m_InputArgs.inputfile.c_str(), itk::ImageIOFactory::ReadMode );
+    m_ImageIO = itk::ImageIOFactory::CreateImageIO( m_InputArgs.inputfile.c_str(), itk::ImageIOFactory::ReadMode );
 
-    if(!imageIO)
+    if(!m_ImageIO)
     {
         std::cerr << "No ImageIO was found Not a valid Nifti" << std::endl;
         return false;
     }
 
-    imageIO->SetFileName(m_InputArgs.inputfile);
-    imageIO->ReadImageInformation();
-
-    if(imageIO->GetPixelType() != itk::ImageIOBase::SCALAR)
+    try
+    {
+        m_ImageIO->SetFileName(m_InputArgs.inputfile);
+        m_ImageIO->ReadImageInformation();
+    }
+    catch ( itk::ExceptionObject & ex )
     {
-        std::cerr << "Only images of type SCALAR are supported." << std::endl;
+        std::string message;
+        message = ex.GetLocation();
+        message += "\n";
+        message += ex.GetDescription();
+        std::cerr << message << std::endl;
         return false;
     }
 
-    if(imageIO->GetNumberOfDimensions() != 3)
+    m_NumberOfComponents = m_ImageIO->GetNumberOfComponents();
+    switch(m_ImageIO->GetPixelType())
     {
-        std::cerr << "Cannot open a " << imageIO->GetNumberOfDimensions() << "D image. Only 3D images are supported." << std::endl;
+        case itk::ImageIOBase::SCALAR:
+            break;
+        case itk::ImageIOBase::RGB:
+        case itk::ImageIOBase::RGBA:
+        case itk::ImageIOBase::VECTOR:
+        {
+            if (m_NumberOfComponents == 3 || m_NumberOfComponents == 4)
+                break;
+            std::cerr << "Cannot open an image with " << m_NumberOfComponents << " components. Only RGB and RGBA images are supported." << std::endl;
+            return false;
+        }
+        default:
+        {
+            std::cerr << "Only images of type SCALAR, RGB and RGBA are supported." << std::endl;
+            return false;
+        }
+    }
+
+    if(m_ImageIO->GetNumberOfDimensions() != 3)
+    {
+        std::cerr << "Cannot open a " << m_ImageIO->GetNumberOfDimensions() << "D image. Only 3D images are supported." << std::endl;
         return false;
     }
-    m_pixelType = imageIO->GetComponentType();
+    m_pixelType = m_ImageIO->GetComponentType();
+
+    return true;
+}
+
+
+bool InputImporter::Import( void )
+{
+    if (!ReadImageInformation())
+        return false;
 
     bool ret = false;
+    if (m_NumberOfComponents > 1)
+    {
+        // Color images, the components are converted to 8 bits by n2d::InputFilter
+        switch(m_pixelType)
+        {
+            case itk::ImageIOBase::UCHAR:
+            {
+                ret = InternalReadColor<unsigned char>();
+                break;
+            }
+            case itk::ImageIOBase::USHORT:
+            {
+                ret = InternalReadColor<unsigned short>();
+                break;
+            }
+            case itk::ImageIOBase::FLOAT:
+            {
+                ret = InternalReadColor<float>();
+                break;
+            }
+            case itk::ImageIOBase::DOUBLE:
+            {
+                ret = InternalReadColor<double>();
+                break;
+            }
+            default:
+            {
+                std::cerr << "ERROR: Unsupported color component type, expected uint8, uint16, float or double" << std::endl;
+                return false;
+            }
+        }
+        return ret;
+    }
+
     switch(m_pixelType)
     {
         case itk::ImageIOBase::UCHAR:
@@ -112,17 +188,85 @@ bool InputImporter::Import( void )
 }
 
 
+template<class TComponent> bool InputImporter::InternalReadColor( )
+{
+    // The components of a pixel are contiguous in the file and in the
+    // buffer of an image of itk::RGBPixel or itk::RGBAPixel.
+    if (m_NumberOfComponents == 3)
+        return InternalRead< itk::RGBPixel<TComponent> >();
+    return InternalRead< itk::RGBAPixel<TComponent> >();
+}
+
+
 template<class TPixel> bool InputImporter::InternalRead( )
 {
     typedef itk::Image<TPixel, Dimension>           InputImageType;
-    typedef itk::ImageFileReader<InputImageType>    ReaderType;
+    typedef itk::ExtractImageFilter<InputImageType, InputImageType> ExtractType;
+
+    // The image is read with the ImageIO used by ReadImageInformation(), as
+    // itk::ImageFileReader would do, so that the ImageIO is not looked up
+    // and the header is not parsed again. TPixel is the component type of
+    // the file, or a pixel of its components, no conversion is needed.
+    typename InputImageType::Pointer output = InputImageType::New();
+    typename InputImageType::RegionType region;
+    typename InputImageType::SpacingType spacing;
+    typename InputImageType::PointType origin;
+    typename InputImageType::DirectionType direction;
+    for (unsigned int i = 0; i < Dimension; i++)
+    {
+        region.SetIndex(i, 0);
+        region.SetSize(i, m_ImageIO->GetDimensions(i));
+        spacing[i] = m_ImageIO->GetSpacing(i);
+        origin[i] = m_ImageIO->GetOrigin(i);
+        const std::vector<double> axis = m_ImageIO->GetDirection(i);
+        for (unsigned int j = 0; j < Dimension; j++)
+            direction[j][i] = axis[j];
+    }
+    if (vnl_det(direction.GetVnlMatrix()) == 0.0)
+        direction.SetIdentity();
+    output->SetLargestPossibleRegion(region);
+    output->SetSpacing(spacing);
+    output->SetOrigin(origin);
+    output->SetDirection(direction);
 
-    typename ReaderType::Pointer reader = ReaderType::New();
-    reader->SetFileName( m_InputArgs.inputfile );
     try
     {
         std::cout << " * \033[1;34mReading input image\033[0m... " << std::endl;
-        reader->Update();
+        const bool range = (m_InputArgs.slicestart != 0 || m_InputArgs.sliceend != 0) && canReadSliceRange();
+        if (range && !tools::GetSliceRegion(output.GetPointer(), m_InputArgs.slicestart, m_InputArgs.sliceend, region))
+            throw itk::ExceptionObject(__FILE__, __LINE__, "The slice range is outside the image", ITK_LOCATION);
+
+        // Only the requested slices are read, if the ImageIO supports it,
+        // their index in the volume is preserved. As for the slices
+        // extracted below, they are the largest possible region of the
+        // image, otherwise filters (e.g. itk::CastImageFilter) would request
+        // the slices that were not read.
+        const bool streamed = range && m_ImageIO->CanStreamRead();
+        const typename InputImageType::RegionType readRegion = streamed ? region : output->GetLargestPossibleRegion();
+        output->SetLargestPossibleRegion(readRegion);
+        output->SetBufferedRegion(readRegion);
+        output->SetRequestedRegion(readRegion);
+        output->Allocate();
+
+        itk::ImageIORegion ioRegion(Dimension);
+        for (unsigned int i = 0; i < Dimension; i++)
+        {
+            ioRegion.SetIndex(i, readRegion.GetIndex(i));
+            ioRegion.SetSize(i, readRegion.GetSize(i));
+        }
+        m_ImageIO->SetIORegion(ioRegion);
+        m_ImageIO->Read(output->GetBufferPointer());
+
+        if (range && !streamed)
+        {
+            typename ExtractType::Pointer extract = ExtractType::New();
+            extract->SetInput( output );
+            extract->SetExtractionRegion( region );
+            extract->SetDirectionCollapseToSubmatrix();
+            extract->Update();
+            output = extract->GetOutput();
+            output->DisconnectPipeline();
+        }
         std::cout << " * \033[1;34mReading input image\033[0m... \033[1;32mDONE\033[0m" << std::endl;
     }
     catch ( itk::ExceptionObject & ex )
@@ -135,8 +279,8 @@ template<class TPixel> bool InputImporter::InternalRead( )
         std::cerr << message << std::endl;
         return false;
     }
-    m_ImportedImage = reader->GetOutput();
-    m_dictionary    = &(reader->GetMetaDataDictionary());
+    m_ImportedImage = output;
+    m_dictionary    = &(m_ImageIO->GetMetaDataDictionary());
 
     return true;
 }
@@ -31,6 +31,11 @@ namespace n2d {
 /*!
  * \brief Imports a 3D image
  *
+ * Scalar images are read with their pixel type. RGB and RGBA images (and
+ * vector images with 3 or 4 components) are read as itk::RGBPixel or
+ * itk::RGBAPixel of their component type, which is then the pixel type
+ * returned by getPixelType().
+ *
  * \warning Image format must be supported by ITK
  * \todo Copy MetaDataDictionary ?
  */
@@ -39,7 +44,8 @@ class InputImporter
 
 public:
     InputImporter(const InputArgs& inputArgs) :
-            m_InputArgs(inputArgs)
+            m_InputArgs(inputArgs),
+            m_NumberOfComponents(1)
     {
     }
 
@@ -52,6 +58,16 @@ public:
  */
     inline n2d::DictionaryType& getMetaDataDictionary( void ) const { return *m_dictionary; }
 
+/*!
+ * \brief Read the header of the image, without reading its voxels.
+ *
+ * The ImageIO is then available through getImageIO().
+ *
+ * \return false if the image cannot be read or is not a 3D scalar, RGB or
+ * RGBA image.
+ */
+    bool ReadImageInformation( void );
+
 /*!
  * \brief Import a 3D image image.
  *
@@ -76,15 +92,44 @@ public:
 */
     inline n2d::PixelType getPixelType(void) const{return m_pixelType; }
 
+/*!
+* \brief Get the number of components of the imported image.
+*
+* \return 1 for scalar images, 3 for RGB images and 4 for RGBA images
+*/
+    inline unsigned int getNumberOfComponents(void) const{return m_NumberOfComponents; }
+
+/*!
+* \brief Whether a slice range (InputArgs::slicestart, InputArgs::sliceend)
+* is read without the rest of the volume.
+*
+* Color components wider than 8 bits are scaled to the largest one of the
+* volume (see InputFilter::ConvertColor()), these images are read whole and
+* the slice range is left to InputFilter.
+*
+* \return Valid after ReadImageInformation()
+*/
+    inline bool canReadSliceRange(void) const{return m_NumberOfComponents == 1 || m_pixelType == itk::ImageIOBase::UCHAR; }
+
+/*!
+* \brief Get the ImageIO used to read the image.
+*
+* \return ImageIO, NULL before ReadImageInformation()
+*/
+    inline itk::ImageIOBase* getImageIO(void) const{return m_ImageIO; }
+
 
 private:
     const InputArgs&         m_InputArgs; //!< Input Arguments.
     n2d::ImageType::Pointer  m_ImportedImage; //!< Imported image.
     n2d::PixelType           m_pixelType; //!< Imported image pixel type.
+    unsigned int             m_NumberOfComponents; //!< Imported image number of components.
     n2d::DictionaryType*     m_dictionary; //!< Nifti tags dictionary.
+    itk::ImageIOBase::Pointer m_ImageIO; //!< ImageIO of the input file.
 
 
     template<class TPixel> bool InternalRead();
+    template<class TComponent> bool InternalReadColor();
 
 };
 //END class n2d::InputImporter
@@ -28,6 +28,8 @@ namespace n2d {
 //BEGIN DICOM tags
 const std::string instancenumbertag ( "0020|0013" );
 const std::string slicethicknesstag ( "0018|0050" );
+const std::string smallestpixelvaluetag ( "0028|0106" );
+const std::string largestpixelvaluetag  ( "0028|0107" );
 
 //END DICOM tags
 
@@ -50,7 +52,11 @@ bool Instance::Update(void)
 
 
 //BEGIN Image info
-    unsigned int nbSlices = (m_Image->GetLargestPossibleRegion().GetSize())[2];
+    // The image can be a range of slices of the volume (see FiltersArgs::slicestart)
+    // or a cropped region (see FiltersArgs::crop), instance numbers and positions
+    // are those of the whole volume.
+    const std::size_t nbSlices = (m_Image->GetLargestPossibleRegion().GetSize())[2];
+    const ImageType::IndexValueType firstSlice = (m_Image->GetLargestPossibleRegion().GetIndex())[2];
     std::vector<n2d::SeriesWriterType::DictionaryRawPointer> dictionaryRaw(nbSlices);
 
     ImageType::PointType position;
@@ -62,8 +68,9 @@ bool Instance::Update(void)
 
     std::ostringstream value;
     value << std::dec << std::setprecision(15);
+    std::size_t nbMatched = 0;
 
-    for (unsigned int i=0; i<nbSlices; i++)
+    for (std::size_t i=0; i<nbSlices; i++)
     {
     //BEGIN MetaDataDictionary copy
         dictionaryRaw[i] = new SeriesWriterType::DictionaryType;
@@ -74,7 +81,7 @@ bool Instance::Update(void)
 
     //BEGIN (0020,0013) Instance Number
         value.str("");
-        value << i + 1;
+        value << firstSlice + i + 1;
         itk::EncapsulateMetaData<std::string>(*dictionaryRaw[i], instancenumbertag, value.str());
     //END (0020,0013) Instance Number
 
@@ -88,6 +95,20 @@ bool Instance::Update(void)
 
 
 
+    //BEGIN (0028,0106) Smallest Image Pixel Value and (0028,0107) Largest Image Pixel Value
+        if (i < m_SliceMinimum.size())
+        {
+            value.str("");
+            value << m_SliceMinimum[i];
+            itk::EncapsulateMetaData<std::string>(*dictionaryRaw[i], smallestpixelvaluetag, value.str());
+            value.str("");
+            value << m_SliceMaximum[i];
+            itk::EncapsulateMetaData<std::string>(*dictionaryRaw[i], largestpixelvaluetag, value.str());
+        }
+    //END (0028,0106) Smallest Image Pixel Value and (0028,0107) Largest Image Pixel Value
+
+
+
 //WARNING In the future this part could be useless
 //BEGIN ITK Tags
 
@@ -97,9 +118,8 @@ bool Instance::Update(void)
 
 
     //BEGIN ITK_Origin
-        index[0] = 0;
-        index[1] = 0;
-        index[2] = i;
+        index = m_Image->GetLargestPossibleRegion().GetIndex();
+        index[2] = firstSlice + i;
         m_Image->TransformIndexToPhysicalPoint(index, position);
         typedef itk::Array< double > DoubleArrayType;
         DoubleArrayType originArray(3);
@@ -128,12 +148,30 @@ bool Instance::Update(void)
 
 //END ITK Tags
 
+
+
+    //BEGIN Reference series per-slice attributes
+        if (!m_SliceHeaders.IsEmpty())
+        {
+            const DictionaryType* sliceDict = m_SliceHeaders.Find(position, direction);
+            if (sliceDict)
+            {
+                n2d::tools::CopyDictionary(*sliceDict, *dictionaryRaw[i]);
+                ++nbMatched;
+            }
+        }
+    //END Reference series per-slice attributes
+
         m_DictionaryArray.push_back(dictionaryRaw[i]);
     }
 
+    if (!m_SliceHeaders.IsEmpty())
+        std::cout << " * \033[1;34mReference series\033[0m: " << nbMatched << " of " << nbSlices
+                  << " slices matched" << std::endl;
+
 #ifdef DEBUG
     std::cout << "Instance - END:" << std::endl << std::endl;
-    for (unsigned int i=0; i<nbSlices; i++)
+    for (std::size_t i=0; i<nbSlices; i++)
     {
         std::cout << " * m_DictionaryArray[" << i << "]" << std::endl;
         tools::PrintDictionary(*m_DictionaryArray[i]);
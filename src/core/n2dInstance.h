@@ -23,6 +23,9 @@
 #include "n2dDefsCommandLineArgsStructs.h"
 #include "n2dDefsMetadata.h"
 #include "n2dDefsImage.h"
+#include "n2dToolsSliceHeaderIndex.h"
+
+#include <vector>
 
 namespace n2d {
 
@@ -35,6 +38,11 @@ namespace n2d {
  *
  * \li (0020,0013) Instance Number
  * \li (0018|0050) Slice Thickness
+ * \li (0028,0106) Smallest Image Pixel Value
+ * \li (0028,0107) Largest Image Pixel Value
+ *
+ * (0028,0106) and (0028,0107) are written only if the range of the values
+ * of each slice was collected by n2d::InputFilter.
  *
  * Also handles:
  *
@@ -43,6 +51,9 @@ namespace n2d {
  * \li ITK_Spacing
  * \li ITK_ZDirection
  *
+ * If a reference series was imported (see n2d::HeaderImporter), its per-slice
+ * attributes are copied to the slices at the same position.
+ *
  * These "ITK_" tags are used by itkGDCMImageIO to know 3D information of a 2D slice but maybe in the future they'll be handled by itkSeriesWriter.
  * \note In future this class could be unuseful because handled by ITK + GDCM2 or maybe ITK will set correctly ITK_ tags.
  * \note ITK_ZDirection is not supported by ITK at the moment, a patch was submitted to support it.
@@ -50,10 +61,15 @@ namespace n2d {
 class Instance
 {
 public:
-    Instance(const InstanceArgs& instanceArgs, DICOM3DImageType::ConstPointer image, DictionaryType& dict, DictionaryArrayType& dictionaryArray) :
+    Instance(const InstanceArgs& instanceArgs, ImageType::ConstPointer image, DictionaryType& dict,
+             const tools::SliceHeaderIndex& sliceHeaders, const std::vector<double>& sliceMinimum,
+             const std::vector<double>& sliceMaximum, DictionaryArrayType& dictionaryArray) :
             m_InstanceArgs(instanceArgs),
             m_Image(image),
             m_Dict(dict),
+            m_SliceHeaders(sliceHeaders),
+            m_SliceMinimum(sliceMinimum),
+            m_SliceMaximum(sliceMaximum),
             m_DictionaryArray(dictionaryArray)
     {
     }
@@ -63,8 +79,11 @@ public:
 
 private:
     const InstanceArgs& m_InstanceArgs;
-    DICOM3DImageType::ConstPointer m_Image;
+    ImageType::ConstPointer m_Image;
     DictionaryType& m_Dict;
+    const tools::SliceHeaderIndex& m_SliceHeaders;
+    const std::vector<double>& m_SliceMinimum; //!< Smallest value of each slice, or empty
+    const std::vector<double>& m_SliceMaximum; //!< Largest value of each slice, or empty
     DictionaryArrayType& m_DictionaryArray;
 
 
@@ -18,77 +18,386 @@
 
 
 #include "n2dOutputExporter.h"
+#include "n2dSliceWriter.h"
 #include "n2dToolsMetaDataDictionary.h"
+#include "n2dToolsPathTemplate.h"
+#include "n2dToolsManifest.h"
+#include "n2dToolsHash.h"
+#include "n2dToolsSync.h"
+
+#include <itksys/SystemTools.hxx>
+#include <gdcmUIDGenerator.h>
 
 #include <string>
 #include <sstream>
+#include <memory>
+#include <cstdio>
 
 
 namespace n2d {
 
+//BEGIN DICOM tags
+const std::string sopinstanceuidtag ( "0008|0018" );
+
+// Tags generated during the conversion (UIDs, dates and times of the
+// conversion), they are kept from a previous conversion so that the
+// unchanged slices and the new ones still belong to the same series.
+const char* const generatedtags[] = {
+    "0008|0020", // Study Date
+    "0008|0021", // Series Date
+    "0008|0022", // Acquisition Date
+    "0008|0030", // Study Time
+    "0008|0031", // Series Time
+    "0008|0032", // Acquisition Time
+    "0020|000d", // Study Instance UID
+    "0020|000e", // Series Instance UID
+    "0020|0010", // Study ID
+    "0020|0052", // Frame of Reference UID
+    NULL
+};
+//END DICOM tags
+
+
+
+namespace {
+
+// Hash of everything that ends up in the DICOM file of a slice: pixels,
+// geometry and tags. The SOP Instance UID is excluded because it is
+// assigned from the manifest.
+template<class TPixel> std::string SliceHash( const itk::Image<TPixel, Dimension>* image, PixelType pixelType, std::size_t slice, const DictionaryType& dict )
+{
+    tools::Hash hash;
+
+    const ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    const std::size_t sliceSize = static_cast<std::size_t>(size[0]) * size[1];
+    hash.Update(image->GetBufferPointer() + slice * sliceSize, sliceSize * sizeof(TPixel));
+
+    hash.Update(itk::ImageIOBase::GetComponentTypeAsString(pixelType));
+    hash.Update(&size[0], sizeof(size[0]));
+    hash.Update(&size[1], sizeof(size[1]));
+
+    ImageType::IndexType index = image->GetBufferedRegion().GetIndex();
+    index[2] += slice;
+    ImageType::PointType position;
+    image->TransformIndexToPhysicalPoint(index, position);
+    for (unsigned int j = 0; j < Dimension; j++)
+    {
+        const double origin = position[j];
+        const double spacing = image->GetSpacing()[j];
+        hash.Update(&origin, sizeof(origin));
+        hash.Update(&spacing, sizeof(spacing));
+        for (unsigned int k = 0; k < Dimension; k++)
+        {
+            const double direction = image->GetDirection()[j][k];
+            hash.Update(&direction, sizeof(direction));
+        }
+    }
+
+    for (DictionaryType::ConstIterator itr = dict.Begin(); itr != dict.End(); ++itr)
+    {
+        const MetaDataStringType* entryvalue = dynamic_cast<const MetaDataStringType*>( itr->second.GetPointer() );
+        if (entryvalue && itr->first != sopinstanceuidtag)
+        {
+            hash.Update(itr->first);
+            hash.Update(entryvalue->GetMetaDataObjectValue());
+        }
+    }
+
+    return hash.GetHexDigest();
+}
+
+} // namespace
+
+
+
+bool OutputExporter::LoadPreviousTags( const OutputArgs& outputArgs, DictionaryType& dict )
+{
+    // The journal of an interrupted conversion is more recent than the
+    // manifest of the last complete one.
+    tools::Manifest manifest;
+    if (!(outputArgs.resume && manifest.Read(outputArgs.outputdirectory + "/" + tools::Journal::GetDefaultFileName())) &&
+        !(outputArgs.incremental && manifest.Read(outputArgs.outputdirectory + "/" + tools::Manifest::GetDefaultFileName())))
+        return false;
+
+    for (const char* const* tag = generatedtags; *tag; ++tag)
+    {
+        tools::Manifest::TagMapType::const_iterator it = manifest.GetTags().find(*tag);
+        if (it != manifest.GetTags().end())
+            itk::EncapsulateMetaData<std::string>(dict, *tag, it->second);
+    }
+    return true;
+}
+
+
+
+
 bool OutputExporter::Export( void )
 {
 #ifdef DEBUG
     std::cout << "OutputExporter - BEGIN" << std::endl;
 #endif // DEBUG
 
-    unsigned int nbSlices = (m_Image->GetLargestPossibleRegion().GetSize())[2];
+    bool ret = false;
+    switch(m_PixelType)
+    {
+        case itk::ImageIOBase::UCHAR:
+        {
+            ret = InternalExport<unsigned char>();
+            break;
+        }
+        case itk::ImageIOBase::USHORT:
+        {
+            ret = InternalExport<unsigned short>();
+            break;
+        }
+        case itk::ImageIOBase::SHORT:
+        {
+            ret = InternalExport<signed short>();
+            break;
+        }
+        case itk::ImageIOBase::UINT:
+        {
+            ret = InternalExport<unsigned int>();
+            break;
+        }
+        default:
+        {
+            std::cerr << "ERROR: Unsupported output pixel type" << std::endl;
+            return false;
+        }
+    }
+
+#ifdef DEBUG
+    std::cout << "OutputExporter - END" << std::endl;
+#endif // DEBUG
+
+    return ret;
+}
+
+
+
+const DictionaryType& OutputExporter::FirstDictionary( void ) const
+{
+#ifndef DONT_USE_ARRAY
+    return *m_DictionaryArray[0];
+#else // DONT_USE_ARRAY
+    return m_Dict;
+#endif // DONT_USE_ARRAY
+}
+
+
+
+template<class TPixel> bool OutputExporter::InternalExport( void )
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>      OutputImageType;
+    //END Typedefs
+
+    typename OutputImageType::ConstPointer image = dynamic_cast<const OutputImageType*>(m_Image.GetPointer());
+    if(!image)
+    {
+        std::cerr << "Error Null Pointer In Exporter" << std::endl;
+        return false;
+    }
+
+    const ImageType::RegionType region = image->GetBufferedRegion();
+    const ImageType::SizeType size = region.GetSize();
+    const std::size_t nbSlices = size[2];
+    // Numbers in the file names are those of the whole volume (see FiltersArgs::slicestart)
+    const std::size_t firstSlice = static_cast<std::size_t>(region.GetIndex()[2]);
 
 //BEGIN Output filename
-    std::ostringstream fmt;
+    std::vector<std::string> names;
+    if (!m_OutputArgs.layout.empty())
+    {
+        // Slice paths relative to the output, built from the tags of each slice
+        tools::PathTemplate layout;
+        if (!layout.Parse(m_OutputArgs.layout))
+        {
+            std::cerr << "ERROR: Invalid layout: " << layout.GetError() << std::endl;
+            return false;
+        }
+        names.reserve(nbSlices);
+        for (std::size_t i = 0; i < nbSlices; i++)
+        {
+#ifndef DONT_USE_ARRAY
+            names.push_back(layout.Expand(*m_DictionaryArray[i], firstSlice + i + 1));
+#else // DONT_USE_ARRAY
+            names.push_back(layout.Expand(m_Dict, firstSlice + i + 1));
+#endif // DONT_USE_ARRAY
+        }
+    }
+    else
+    {
+        std::ostringstream fmt;
 
-    fmt << m_OutputArgs.outputdirectory;
-    fmt << "/";
-    fmt << m_OutputArgs.prefix;
-    fmt << "%0";
-    fmt << m_OutputArgs.digits;
-    fmt << "d";
-    fmt << m_OutputArgs.suffix;
+        fmt << m_OutputArgs.prefix;
+        fmt << "%0";
+        fmt << m_OutputArgs.digits;
+        fmt << "d";
+        fmt << m_OutputArgs.suffix;
 
-    std::string Format = fmt.str();
+        std::string Format = fmt.str();
 #ifdef DEBUG
-    std::cout << "Format: " << Format << std::endl;
+        std::cout << "Format: " << Format << std::endl;
 #endif // DEBUG
 
-    NameGeneratorType::Pointer namesGenerator = NameGeneratorType::New();
-    namesGenerator->SetStartIndex( 1 );
-    namesGenerator->SetEndIndex( nbSlices );
-    namesGenerator->SetIncrementIndex( 1 );
+        NameGeneratorType::Pointer namesGenerator = NameGeneratorType::New();
+        namesGenerator->SetStartIndex( firstSlice + 1 );
+        namesGenerator->SetEndIndex( firstSlice + nbSlices );
+        namesGenerator->SetIncrementIndex( 1 );
 
-    namesGenerator->SetSeriesFormat( Format.c_str() );
+        namesGenerator->SetSeriesFormat( Format.c_str() );
 
+        names = namesGenerator->GetFileNames();
+    }
 //END Output filename
 
 
-    itksys::SystemTools::MakeDirectory( m_OutputArgs.outputdirectory.c_str() ); // Create directory if it does not exist yet
+
+//BEGIN Slice IO
+    // The same information written by itk::ImageSeriesWriter, the 3D
+    // geometry of each slice is in the ITK_ tags set by n2d::Instance.
+    const ImageType::SpacingType spacing = image->GetSpacing();
+    const ImageType::PointType origin = image->GetOrigin();
+    const ImageType::DirectionType direction = image->GetDirection();
+
+    m_DicomIO->SetNumberOfDimensions( DICOMDimension );
+    m_DicomIO->SetPixelType( itk::ImageIOBase::SCALAR );
+    m_DicomIO->SetComponentType( m_PixelType );
+    m_DicomIO->SetNumberOfComponents( 1 );
+
+    itk::ImageIORegion ioRegion( DICOMDimension );
+    for (unsigned int j = 0; j < DICOMDimension; j++)
+    {
+        m_DicomIO->SetDimensions( j, size[j] );
+        m_DicomIO->SetSpacing( j, spacing[j] );
+        m_DicomIO->SetOrigin( j, origin[j] );
+        std::vector<double> axis( DICOMDimension );
+        for (unsigned int k = 0; k < DICOMDimension; k++)
+            axis[k] = direction[k][j];
+        m_DicomIO->SetDirection( j, axis );
+        ioRegion.SetSize( j, size[j] );
+    }
+    m_DicomIO->SetIORegion( ioRegion );
+//END Slice IO
+
 
 
 //BEGIN Writer
-    SeriesWriterType::Pointer seriesWriter = SeriesWriterType::New();
-    seriesWriter->SetInput( m_Image );
-    seriesWriter->SetImageIO( m_DicomIO );
-    seriesWriter->SetFileNames( namesGenerator->GetFileNames() );
+    std::unique_ptr<SliceWriter> writer( SliceWriter::New(m_OutputArgs) );
+    if (!writer->Open())
+        return false;
+
+    const TPixel* buffer = image->GetBufferPointer();
+    const std::size_t sliceSize = static_cast<std::size_t>(size[0]) * size[1];
 
+    // Incremental and resumed conversions: slices whose hash did not change
+    // since the previous conversion, or that were completed before it was
+    // interrupted, are not written again.
+    const bool tracked = m_OutputArgs.incremental || m_OutputArgs.resume;
+    const std::string manifestFileName = m_OutputArgs.outputdirectory + "/" + tools::Manifest::GetDefaultFileName();
+    const std::string journalFileName = m_OutputArgs.outputdirectory + "/" + tools::Journal::GetDefaultFileName();
+    tools::Manifest previousManifest, previousJournal, manifest;
+    tools::Journal journal;
+    if (m_OutputArgs.incremental)
+        previousManifest.Read(manifestFileName);
+    if (m_OutputArgs.resume)
+    {
+        const bool resuming = previousJournal.Read(journalFileName);
+        if (!journal.Open(journalFileName, resuming))
+        {
+            std::cerr << "ERROR: Cannot open " << journalFileName << std::endl;
+            return false;
+        }
+        if (!resuming && nbSlices > 0)
+        {
+            for (const char* const* tag = generatedtags; *tag; ++tag)
+            {
+                std::string value;
+                if (itk::ExposeMetaData<std::string>(FirstDictionary(), *tag, value))
+                    journal.AddTag(*tag, value);
+            }
+        }
+    }
+    gdcm::UIDGenerator uidGenerator;
+    std::size_t nbSkipped = 0;
+
+    try
+    {
+        std::cout << " * \033[1;34mWriting\033[0m... " << std::endl;
+        for (std::size_t i = 0; i < nbSlices; i++)
+        {
 #ifndef DONT_USE_ARRAY
-    seriesWriter->SetMetaDataDictionaryArray( &m_DictionaryArray );
+            DictionaryType& dict = *m_DictionaryArray[i];
 #else // DONT_USE_ARRAY
-    seriesWriter->SetMetaDataDictionary( m_Dict );
-    //seriesWriter->SetMetaDataDictionary(*m_DictionaryArray[0]);
+            DictionaryType& dict = m_Dict;
 #endif // DONT_USE_ARRAY
+            const std::string fileName = m_OutputArgs.outputdirectory + "/" + names[i];
 
+            tools::Manifest::Slice slice;
+            if (tracked)
+            {
+                slice.hash = SliceHash(image.GetPointer(), m_PixelType, i, dict);
+                const tools::Manifest::Slice* previous = previousJournal.FindSlice(names[i]);
+                const bool journaled = (previous != NULL);
+                if (!previous)
+                    previous = previousManifest.FindSlice(names[i]);
+                slice.sopInstanceUID = previous ? previous->sopInstanceUID : uidGenerator.Generate();
+                manifest.SetSlice(names[i], slice);
 
-//BEGIN FIXME (see n2dOutputExporter.h)
-//   CommandUpdate::Pointer observer = CommandUpdate::New();
-//   seriesWriter->AddObserver(itk::AnyEvent(), observer);
-//END FIXME (see n2dOutputExporter.h)
+                if (previous && previous->hash == slice.hash && itksys::SystemTools::FileExists(fileName))
+                {
+                    ++nbSkipped;
+                    if (m_OutputArgs.resume && !journaled && !journal.AddSlice(names[i], slice))
+                        throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot write " + journalFileName, ITK_LOCATION);
+                    continue;
+                }
+                itk::EncapsulateMetaData<std::string>(dict, sopinstanceuidtag, slice.sopInstanceUID);
+            }
 
-//    n2d::tools::PrintDictionary(*m_DictionaryArray[1]);
-//    std::cout << std::hex << m_DictionaryArray[1] << std::endl;
+            m_DicomIO->SetMetaDataDictionary( dict );
+            m_DicomIO->SetFileName( writer->GetSliceFileName(names[i]) );
+            m_DicomIO->Write( buffer + i * sliceSize );
 
-    try
-    {
-        std::cout << " * \033[1;34mWriting\033[0m... " << std::endl;
-        seriesWriter->Update();
+            if (!writer->SliceWritten(names[i]))
+                throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot write " + names[i], ITK_LOCATION);
+
+            // A slice is journaled only once it is on stable storage
+            if (m_OutputArgs.resume)
+            {
+                if (m_OutputArgs.sync != "file" && !tools::SyncFile(fileName))
+                    throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot sync " + names[i], ITK_LOCATION);
+                if (!journal.AddSlice(names[i], slice))
+                    throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot write " + journalFileName, ITK_LOCATION);
+            }
+        }
+        if (!writer->Close())
+            throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot complete the output", ITK_LOCATION);
+
+        if (m_OutputArgs.incremental && nbSlices > 0)
+        {
+            for (const char* const* tag = generatedtags; *tag; ++tag)
+            {
+                std::string value;
+                if (itk::ExposeMetaData<std::string>(FirstDictionary(), *tag, value))
+                    manifest.SetTag(*tag, value);
+            }
+            // Written last, an interrupted conversion leaves the previous one
+            if (!manifest.Write(manifestFileName) ||
+                (m_OutputArgs.sync != "none" && !tools::SyncFile(manifestFileName)))
+                throw itk::ExceptionObject(__FILE__, __LINE__, "Cannot write " + manifestFileName, ITK_LOCATION);
+        }
+
+        // The conversion is complete, there is nothing left to resume
+        if (m_OutputArgs.resume)
+        {
+            journal.Close();
+            std::remove(journalFileName.c_str());
+        }
+
+        if (tracked)
+            std::cout << "   " << nbSkipped << " of " << nbSlices << " slices skipped" << std::endl;
         std::cout << " * \033[1;34mWriting\033[0m... \033[1;32mDONE\033[0m" << std::endl;
     }
     catch ( itk::ExceptionObject & ex )
@@ -103,10 +412,6 @@ bool OutputExporter::Export( void )
     }
 //END Writer
 
-#ifdef DEBUG
-    std::cout << "OutputExporter - END" << std::endl;
-#endif // DEBUG
-
     return true;
 }
 
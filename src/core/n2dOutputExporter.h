@@ -31,25 +31,28 @@ namespace n2d {
 
 //BEGIN class n2d::OutputExporter
 /*!
- * \brief [...]
+ * \brief Writes the filtered image as a DICOM series
  *
+ * The image is written using the pixel type chosen by n2d::InputFilter.
  */
 class OutputExporter
 {
 public:
 
 #ifndef DONT_USE_ARRAY
-    OutputExporter(const OutputArgs& outputArgs, DICOM3DImageType::ConstPointer image, DictionaryArrayType& dictionaryArray, DICOMImageIOType::Pointer dicomIO) :
+    OutputExporter(const OutputArgs& outputArgs, ImageType::ConstPointer image, PixelType pixelType, DictionaryArrayType& dictionaryArray, DICOMImageIOType::Pointer dicomIO) :
             m_OutputArgs(outputArgs),
             m_Image(image),
+            m_PixelType(pixelType),
             m_DictionaryArray(dictionaryArray),
             m_DicomIO(dicomIO)
     {
     }
 #else // DONT_USE_ARRAY
-    OutputExporter(const OutputArgs& outputArgs, DICOM3DImageType::ConstPointer image, DictionaryType& dictionary, DICOMImageIOType::Pointer dicomIO) :
+    OutputExporter(const OutputArgs& outputArgs, ImageType::ConstPointer image, PixelType pixelType, DictionaryType& dictionary, DICOMImageIOType::Pointer dicomIO) :
             m_OutputArgs(outputArgs),
             m_Image(image),
+            m_PixelType(pixelType),
             m_Dict(dictionary),
             m_DicomIO(dicomIO)
     {
@@ -60,9 +63,25 @@ public:
 
     bool Export( void );
 
+/*!
+ * \brief Restore the tags generated by a previous conversion.
+ *
+ * Used for incremental and resumed conversions (OutputArgs::incremental,
+ * OutputArgs::resume): UIDs, dates and times found in the journal or in
+ * the manifest of the output directory are put in the dictionary, so that
+ * they are not generated again.
+ *
+ * \return false if there is no previous conversion.
+ */
+    static bool LoadPreviousTags( const OutputArgs& outputArgs, DictionaryType& dict );
+
 private:
+    template<class TPixel> bool InternalExport( void );
+    const DictionaryType& FirstDictionary( void ) const;
+
     const OutputArgs& m_OutputArgs;
-    DICOM3DImageType::ConstPointer m_Image;
+    ImageType::ConstPointer m_Image;
+    PixelType m_PixelType;
 
 #ifndef DONT_USE_ARRAY
     DictionaryArrayType& m_DictionaryArray;
@@ -74,50 +93,6 @@ private:
 };
 //END class n2d::OutputExporter
 
-
-//BEGIN FIXME
-//FIXME This command is needed because "seriesWriter->Update()" causes a segmentation fault after
-//      writing the second image (I cannot find a reason for this)
-//      Adding a command fix this, but this behaviour should be investigated.
-
-#include "itkCommand.h"
-
-class CommandUpdate : public itk::Command
-{
-public:
-    typedef CommandUpdate Self;
-    typedef itk::Command Superclass;
-    typedef itk::SmartPointer<Self> Pointer;
-    itkNewMacro( Self );
-
-protected:
-    CommandUpdate() {}
-
-    inline void Execute(itk::Object* object, const itk::EventObject& event)
-    {
-        Execute( (const itk::Object*)object, event);
-    }
-
-    inline void Execute(const itk::Object *object, const itk::EventObject & event )
-    {
-        if ( ! itk::ProgressEvent().CheckEvent( &event ) )
-        {
-            return;
-        }
-
-        const SeriesWriterType* ptr = dynamic_cast<const SeriesWriterType*>(object);
-        if (ptr)
-        {
-            std::cout << "\t" << (ptr->GetProgress())*100 << "%" << std::endl;
-        }
-    }
-
-
-};
-
-//END FIXME
-
-
 }
 
 #endif // N2DOUTPUTEXPORTER_H
@@ -0,0 +1,426 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "n2dProbe.h"
+#include "n2dInputImporter.h"
+#include "n2dInputFilter.h"
+#include "n2dToolsResampling.h"
+
+#include <vnl/vnl_det.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+
+namespace n2d {
+
+//BEGIN Default values
+const unsigned long long headerbytes     = 2048;             //!< Estimated size of the header of a slice
+const unsigned long long dictionarybytes = 16 * 1024;        //!< Estimated size of the tags of a slice in memory
+const unsigned long long baselinebytes   = 32 * 1024 * 1024; //!< Estimated memory used before reading the image
+const unsigned int storescuqueuedepth    = 4;                //!< See tools::StoreSCU
+//END Default values
+
+
+//BEGIN Transfer syntaxes
+/*!
+ * \brief Transfer syntax, with the typical compression ratio of the pixel
+ * data of CT and MR slices and the worst case expansion of the pixel data.
+ */
+struct ProbeTransferSyntax
+{
+    const char* uid;
+    const char* name;
+    double ratio;
+    double expansion;
+};
+
+static const ProbeTransferSyntax transfersyntaxes[] =
+{
+    { "1.2.840.10008.1.2.1",    "Explicit VR Little Endian", 1.0, 1.0  },
+    { "1.2.840.10008.1.2",      "Implicit VR Little Endian", 1.0, 1.0  },
+    { "1.2.840.10008.1.2.5",    "RLE Lossless",              1.8, 1.01 },
+    { "1.2.840.10008.1.2.4.80", "JPEG-LS Lossless",          2.5, 1.05 },
+    { "1.2.840.10008.1.2.4.90", "JPEG 2000 Lossless",        2.5, 1.05 }
+};
+
+// The transfer syntax of the slices written by nifti2dicom
+const std::string writtentransfersyntax ( "1.2.840.10008.1.2.1" );
+//END Transfer syntaxes
+
+
+
+static std::string JSONString(const std::string& value)
+{
+    std::ostringstream out;
+    out << '"';
+    for (std::string::size_type i = 0; i < value.size(); ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c == '"' || c == '\\')
+            out << '\\' << value[i];
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        }
+        else
+            out << value[i];
+    }
+    out << '"';
+    return out.str();
+}
+
+
+
+static const char* OutputTypeName(PixelType pixelType)
+{
+    switch(pixelType)
+    {
+        case itk::ImageIOBase::UCHAR:  return "uint8";
+        case itk::ImageIOBase::USHORT: return "uint16";
+        case itk::ImageIOBase::SHORT:  return "int16";
+        case itk::ImageIOBase::UINT:   return "uint32";
+        default:                       return "unknown";
+    }
+}
+
+
+
+static unsigned int OutputPixelSize(PixelType pixelType)
+{
+    switch(pixelType)
+    {
+        case itk::ImageIOBase::UCHAR:  return 1;
+        case itk::ImageIOBase::USHORT: return 2;
+        case itk::ImageIOBase::SHORT:  return 2;
+        default:                       return 4;
+    }
+}
+
+
+
+/*!
+ * \brief Finds, for each axis of the reoriented image, the axis of the image
+ * it comes from.
+ *
+ * Each axis of the image is matched to the anatomical axis closest to its
+ * direction, as itk::OrientImageFilter does.
+ *
+ * \return false if \c orientation is not one of the 48 orientation codes.
+ */
+static bool ReorientedAxes(const itk::ImageIOBase* imageIO, const std::string& orientation, unsigned int axes[3])
+{
+    if (orientation.size() != 3)
+        return false;
+
+    int desired[3];
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+        switch(orientation[k])
+        {
+            case 'R': case 'L': desired[k] = 0; break;
+            case 'A': case 'P': desired[k] = 1; break;
+            case 'I': case 'S': desired[k] = 2; break;
+            default: return false;
+        }
+    }
+    if (desired[0] == desired[1] || desired[0] == desired[2] || desired[1] == desired[2])
+        return false;
+
+    int anatomical[3];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        const std::vector<double> direction = imageIO->GetDirection(i);
+        anatomical[i] = 0;
+        for (int j = 1; j < 3; ++j)
+            if (std::fabs(direction[j]) > std::fabs(direction[anatomical[i]]))
+                anatomical[i] = j;
+    }
+    if (anatomical[0] == anatomical[1] || anatomical[0] == anatomical[2] || anatomical[1] == anatomical[2])
+    {
+        // Oblique image, the axes are kept
+        for (unsigned int k = 0; k < 3; ++k)
+            axes[k] = k;
+        return true;
+    }
+
+    for (unsigned int k = 0; k < 3; ++k)
+        for (unsigned int i = 0; i < 3; ++i)
+            if (anatomical[i] == desired[k])
+                axes[k] = i;
+    return true;
+}
+
+
+
+/*!
+ * \brief Number of slices in [start, end) of an image whose slices are
+ * [first, first + count), as tools::GetSliceRegion() computes it.
+ *
+ * \return false if there is no slice in the range.
+ */
+static bool SliceRangeCount(unsigned long long first, unsigned long long count, unsigned long long start, unsigned long long end, unsigned long long& slices)
+{
+    const unsigned long long last = first + count;
+    const unsigned long long rangeEnd = end == 0 ? last : (end < last ? end : last);
+    if (start < first || start >= rangeEnd)
+        return false;
+    slices = rangeEnd - start;
+    return true;
+}
+
+
+
+bool Probe::Run( std::ostream& out )
+{
+//BEGIN Input
+    InputImporter importer(m_InputArgs);
+    if (!importer.ReadImageInformation())
+        return false;
+    itk::ImageIOBase* imageIO = importer.getImageIO();
+
+    unsigned long long inputSize[3];
+    double inputSpacing[3];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        inputSize[i] = imageIO->GetDimensions(i);
+        inputSpacing[i] = imageIO->GetSpacing(i);
+    }
+    const unsigned int inputComponents = importer.getNumberOfComponents();
+    const unsigned long long inputPixelSize = imageIO->GetComponentSize() * inputComponents;
+
+    // Slices read (see InputImporter::Import())
+    const bool inputRange = (m_InputArgs.slicestart != 0 || m_InputArgs.sliceend != 0) && importer.canReadSliceRange();
+    if (m_InputArgs.slab > 0 && !importer.canReadSliceRange())
+    {
+        std::cerr << "ERROR: Color images with components wider than 8 bits are scaled on the whole volume, they cannot be converted in slabs" << std::endl;
+        return false;
+    }
+    if (m_InputArgs.slab > 0 && !imageIO->CanStreamRead())
+    {
+        std::cerr << "ERROR: The slices of \"" << m_InputArgs.inputfile << "\" cannot be read on their own (e.g. compressed file), they cannot be converted in slabs" << std::endl;
+        return false;
+    }
+    unsigned long long importedSize[3] = { inputSize[0], inputSize[1], inputSize[2] };
+    if (inputRange && !SliceRangeCount(0, inputSize[2], m_InputArgs.slicestart, m_InputArgs.sliceend, importedSize[2]))
+    {
+        std::cerr << "ERROR: The slice range is outside the image" << std::endl;
+        return false;
+    }
+    const bool streamed = inputRange && imageIO->CanStreamRead();
+//END Input
+
+
+
+//BEGIN Filters
+    const bool reorient = (m_FiltersArgs.reorient != "NO_REORIENT");
+    unsigned int axes[3] = { 0, 1, 2 };
+    if (reorient && !ReorientedAxes(imageIO, m_FiltersArgs.reorient, axes))
+    {
+        std::cerr << "ERROR: Unknown reorient type" << std::endl;
+        return false;
+    }
+    unsigned long long reorientedSize[3];
+    double reorientedSpacing[3];
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+        reorientedSize[k] = importedSize[axes[k]];
+        reorientedSpacing[k] = inputSpacing[axes[k]];
+    }
+
+    // Axis-aligned images are reoriented while converting the pixels, only
+    // oblique ones get a reoriented copy from itk::OrientImageFilter (see
+    // InputFilter::GetReorientation()). Color images are never copied.
+    bool reorientedCopy = false;
+    if (reorient && inputComponents == 1)
+    {
+        ImageType::DirectionType direction;
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            const std::vector<double> axis = imageIO->GetDirection(i);
+            for (unsigned int j = 0; j < 3; ++j)
+                direction[j][i] = axis[j];
+        }
+        // As InputImporter::InternalRead() does
+        if (vnl_det(direction.GetVnlMatrix()) == 0.0)
+            direction.SetIdentity();
+        InputFilter::Reorientation reorientation;
+        reorientedCopy = !InputFilter::GetReorientation(direction, m_FiltersArgs.reorient, reorientation);
+    }
+
+    // Resampled onto the grid of the reoriented image (see InputFilter::Resample())
+    const bool resample = (m_FiltersArgs.resample != "none");
+    unsigned long long filteredSize[3] = { reorientedSize[0], reorientedSize[1], reorientedSize[2] };
+    double outputSpacing[3] = { reorientedSpacing[0], reorientedSpacing[1], reorientedSpacing[2] };
+    if (resample)
+        tools::GetResampledGrid(m_FiltersArgs.resample, m_FiltersArgs.resamplevalues, reorientedSize, reorientedSpacing, filteredSize, outputSpacing);
+
+    // Slices written (see InputFilter::Filter())
+    const bool filterRange = (m_FiltersArgs.slicestart != 0 || m_FiltersArgs.sliceend != 0);
+    unsigned long long slices = filteredSize[2];
+    if (filterRange && !SliceRangeCount(inputRange ? m_InputArgs.slicestart : 0, filteredSize[2], m_FiltersArgs.slicestart, m_FiltersArgs.sliceend, slices))
+    {
+        std::cerr << "ERROR: The slice range is outside the image" << std::endl;
+        return false;
+    }
+
+    PixelType outputPixelType;
+    bool exact;
+    if (!InputFilter::PlanOutputPixelType(m_FiltersArgs, importer.getPixelType(), outputPixelType, exact))
+        return false;
+    // Color images are written as 8 bits RGB (see InputFilter::ConvertColor())
+    const unsigned int outputComponents = inputComponents > 1 ? 3 : 1;
+    if (inputComponents > 1)
+    {
+        outputPixelType = itk::ImageIOBase::UCHAR;
+        exact = true;
+    }
+    // The bounding box of the content depends on the voxels
+    if (m_FiltersArgs.crop)
+        exact = false;
+    const unsigned long long outputPixelSize = OutputPixelSize(outputPixelType) * outputComponents;
+//END Filters
+
+
+
+//BEGIN Sizes
+    const unsigned long long inputVoxels = inputSize[0] * inputSize[1] * inputSize[2];
+    const unsigned long long importedVoxels = importedSize[0] * importedSize[1] * importedSize[2];
+    const unsigned long long filteredVoxels = filteredSize[0] * filteredSize[1] * filteredSize[2];
+    const unsigned long long sliceVoxels = filteredSize[0] * filteredSize[1];
+
+    const unsigned long long inputBytes = inputVoxels * inputPixelSize;
+    const unsigned long long importedBytes = importedVoxels * inputPixelSize;
+    const unsigned long long resampledBytes = resample ? filteredVoxels * inputPixelSize : 0;
+    const unsigned long long filteredBytes = filteredVoxels * outputPixelSize;
+    const unsigned long long outputBytes = slices * sliceVoxels * outputPixelSize;
+
+    // Pixel Data has an even length
+    unsigned long long slicePixelBytes = sliceVoxels * outputPixelSize;
+    slicePixelBytes += slicePixelBytes % 2;
+    const unsigned long long sliceFileBytes = headerbytes + slicePixelBytes;
+//END Sizes
+
+
+
+//BEGIN Memory
+    // Encoded slices held at the same time by the slice writer (see SliceWriter::New())
+    unsigned long long inFlight = 1;
+    if (!m_OutputArgs.storescu.empty())
+        inFlight = storescuqueuedepth + 1;
+    else if (!m_OutputArgs.stowrs.empty())
+        inFlight = static_cast<unsigned long long>(m_OutputArgs.stowbatch) * (2 * m_OutputArgs.stowconnections + 1);
+    else if (m_OutputArgs.outputarchive.empty() && m_OutputArgs.outputdirectory != "-" && m_OutputArgs.writequeue > 0 && !m_OutputArgs.resume)
+        inFlight = m_OutputArgs.writequeue + 1;
+
+    // With --slab, a slab at most is read, filtered and written at a time,
+    // as a slice range (the slices of the input are those of the output).
+    const bool slabbed = m_InputArgs.slab > 0 && m_InputArgs.slab < slices;
+    const unsigned long long heldSlices = slabbed ? m_InputArgs.slab : slices;
+    const unsigned long long heldImportedBytes = slabbed ? importedSize[0] * importedSize[1] * heldSlices * inputPixelSize : importedBytes;
+    const unsigned long long heldFilteredBytes = slabbed ? heldSlices * sliceVoxels * outputPixelSize : filteredBytes;
+    const unsigned long long heldOutputBytes = slabbed ? heldSlices * sliceVoxels * outputPixelSize : outputBytes;
+    const bool heldRange = slabbed || inputRange;
+    const bool heldStreamed = slabbed || streamed;
+
+    // Reading: the slice range is copied out of the whole image, or of the
+    // slices read if the ImageIO can stream.
+    const unsigned long long readPeak = heldRange ? (heldStreamed ? heldImportedBytes : inputBytes) + heldImportedBytes : heldImportedBytes;
+    // Filtering: input, reoriented copy, resampled copy, output and the slice
+    // range of the output
+    const unsigned long long filterPeak = heldImportedBytes + (reorientedCopy ? heldImportedBytes : 0) + resampledBytes + heldFilteredBytes + (filterRange ? heldOutputBytes : 0);
+    // Writing: input and output volumes, tags of each slice, slices being encoded
+    // (GDCM copies the pixel data of the slice) and in flight.
+    const unsigned long long writePeak = heldImportedBytes + heldOutputBytes + heldSlices * dictionarybytes + (inFlight + 2) * sliceFileBytes;
+
+    unsigned long long peak = readPeak;
+    if (filterPeak > peak)
+        peak = filterPeak;
+    if (writePeak > peak)
+        peak = writePeak;
+    peak += baselinebytes;
+//END Memory
+
+
+
+//BEGIN JSON
+    std::ostringstream json;
+    json.precision(10);
+    json << "{" << std::endl;
+
+    json << "  \"input\": {" << std::endl;
+    json << "    \"file\": " << JSONString(m_InputArgs.inputfile) << "," << std::endl;
+    json << "    \"size\": [" << inputSize[0] << ", " << inputSize[1] << ", " << inputSize[2] << "]," << std::endl;
+    json << "    \"spacing\": [" << inputSpacing[0] << ", " << inputSpacing[1] << ", " << inputSpacing[2] << "]," << std::endl;
+    json << "    \"pixelType\": " << JSONString(itk::ImageIOBase::GetComponentTypeAsString(importer.getPixelType())) << "," << std::endl;
+    json << "    \"components\": " << inputComponents << "," << std::endl;
+    json << "    \"bytes\": " << inputBytes << "," << std::endl;
+    json << "    \"slicesRead\": " << importedSize[2] << "," << std::endl;
+    json << "    \"streamed\": " << (heldStreamed ? "true" : "false") << "," << std::endl;
+    json << "    \"slab\": " << heldSlices << std::endl;
+    json << "  }," << std::endl;
+
+    json << "  \"output\": {" << std::endl;
+    json << "    \"size\": [" << filteredSize[0] << ", " << filteredSize[1] << ", " << slices << "]," << std::endl;
+    json << "    \"spacing\": [" << outputSpacing[0] << ", " << outputSpacing[1] << ", " << outputSpacing[2] << "]," << std::endl;
+    json << "    \"pixelType\": " << JSONString(OutputTypeName(outputPixelType)) << "," << std::endl;
+    json << "    \"samplesPerPixel\": " << outputComponents << "," << std::endl;
+    json << "    \"exact\": " << (exact ? "true" : "false") << "," << std::endl;
+    json << "    \"slices\": " << slices << "," << std::endl;
+    json << "    \"slicePixelBytes\": " << slicePixelBytes << std::endl;
+    json << "  }," << std::endl;
+
+    json << "  \"transferSyntaxes\": [" << std::endl;
+    const std::size_t count = sizeof(transfersyntaxes) / sizeof(transfersyntaxes[0]);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const ProbeTransferSyntax& ts = transfersyntaxes[i];
+        const unsigned long long estimated = headerbytes + static_cast<unsigned long long>(std::ceil(slicePixelBytes / ts.ratio));
+        const unsigned long long maximum = headerbytes + static_cast<unsigned long long>(std::ceil(slicePixelBytes * ts.expansion));
+        json << "    {" << std::endl;
+        json << "      \"uid\": " << JSONString(ts.uid) << "," << std::endl;
+        json << "      \"name\": " << JSONString(ts.name) << "," << std::endl;
+        json << "      \"written\": " << (writtentransfersyntax == ts.uid ? "true" : "false") << "," << std::endl;
+        json << "      \"sliceBytes\": " << estimated << "," << std::endl;
+        json << "      \"totalBytes\": " << estimated * slices << "," << std::endl;
+        json << "      \"maximumTotalBytes\": " << maximum * slices << std::endl;
+        json << "    }" << (i + 1 < count ? "," : "") << std::endl;
+    }
+    json << "  ]," << std::endl;
+
+    json << "  \"memory\": {" << std::endl;
+    json << "    \"readBytes\": " << readPeak << "," << std::endl;
+    json << "    \"filterBytes\": " << filterPeak << "," << std::endl;
+    json << "    \"writeBytes\": " << writePeak << "," << std::endl;
+    json << "    \"peakBytes\": " << peak << std::endl;
+    json << "  }" << std::endl;
+
+    json << "}" << std::endl;
+//END JSON
+
+    out << json.str();
+    out.flush();
+    return out.good();
+}
+
+} // namespace n2d
@@ -0,0 +1,73 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef N2DPROBE_H
+#define N2DPROBE_H
+
+#include "n2dDefsCommandLineArgsStructs.h"
+
+#include <ostream>
+
+
+namespace n2d {
+
+//BEGIN class n2d::Probe
+/*!
+ * \brief Plans a conversion without reading the voxels of the input image.
+ *
+ * Only the header of the input image is read (see
+ * InputImporter::ReadImageInformation()). A JSON document describing the
+ * conversion is written with:
+ *
+ * \li the size, spacing and pixel type of the input and of the output,
+ *     after reorientation and slice range;
+ * \li the number of slices written;
+ * \li the size of the output for each transfer syntax, exact for the pixel
+ *     data of uncompressed syntaxes and estimated for the headers and for
+ *     lossless compressed syntaxes, with an upper bound;
+ * \li an estimate of the peak memory used by each step of the conversion.
+ *
+ * When FiltersArgs::outputtype is "auto" the output pixel type depends on
+ * the voxels, the largest possible one is used and "exact" is false. The
+ * same holds for the size when the output is cropped (FiltersArgs::crop):
+ * the size before cropping is used.
+ */
+class Probe
+{
+public:
+    Probe(const InputArgs& inputArgs, const FiltersArgs& filtersArgs, const OutputArgs& outputArgs) :
+            m_InputArgs(inputArgs),
+            m_FiltersArgs(filtersArgs),
+            m_OutputArgs(outputArgs)
+    {
+    }
+
+    ~Probe() {}
+
+    bool Run( std::ostream& out );
+
+private:
+    const InputArgs& m_InputArgs;
+    const FiltersArgs& m_FiltersArgs;
+    const OutputArgs& m_OutputArgs;
+};
+//END class n2d::Probe
+
+} // namespace n2d
+
+#endif // N2DPROBE_H
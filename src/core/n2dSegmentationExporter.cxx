@@ -0,0 +1,521 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dSegmentationExporter.h"
+#include "n2dSliceWriter.h"
+#include "n2dToolsDate.h"
+#include "n2dVersion.h"
+#include "n2dToolsDataSet.h"
+
+#include <gdcmAttribute.h>
+#include <gdcmUIDGenerator.h>
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+
+namespace n2d {
+
+//BEGIN DICOM tags
+// Tags copied from the dictionary: patient (all of group 0010), study,
+// series, frame of reference and equipment.
+const char* const segmentationcopiedtags[] = {
+    "0008|0005", // Specific Character Set
+    "0008|0020", // Study Date
+    "0008|0021", // Series Date
+    "0008|0030", // Study Time
+    "0008|0031", // Series Time
+    "0008|0050", // Accession Number
+    "0008|0070", // Manufacturer
+    "0008|0080", // Institution Name
+    "0008|0090", // Referring Physician's Name
+    "0008|1030", // Study Description
+    "0008|103e", // Series Description
+    "0008|1090", // Manufacturer's Model Name
+    "0018|1000", // Device Serial Number
+    "0018|1020", // Software Versions
+    "0020|000d", // Study Instance UID
+    "0020|000e", // Series Instance UID
+    "0020|0010", // Study ID
+    "0020|0011", // Series Number
+    "0020|0052", // Frame of Reference UID
+    "0020|1040", // Position Reference Indicator
+    NULL
+};
+//END DICOM tags
+
+
+//BEGIN Default values
+const std::string segmentationsopclassuid    ( "1.2.840.10008.5.1.4.1.1.66.4" );
+const std::string defaultdeviceserialnumber  ( "0" );
+const std::string defaultcontentlabel        ( "SEGMENTATION" );
+//END Default values
+
+
+
+namespace {
+
+gdcm::DataSet CodeItem( const std::string& value, const std::string& scheme, const std::string& meaning )
+{
+    gdcm::DataSet code;
+    tools::SetString(code, gdcm::Tag(0x0008, 0x0100), value);
+    tools::SetString(code, gdcm::Tag(0x0008, 0x0102), scheme);
+    tools::SetString(code, gdcm::Tag(0x0008, 0x0104), meaning);
+    return code;
+}
+
+
+// Calls job() on a pool of threads, at most one per job
+void Run( std::size_t jobs, const std::function<void(void)>& job )
+{
+    unsigned int threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > jobs)
+        threads = jobs > 0 ? static_cast<unsigned int>(jobs) : 1;
+
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; t++)
+        pool.push_back(std::thread(job));
+    job();
+    for (std::size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+}
+
+} // namespace
+
+
+
+bool SegmentationExporter::Export( void )
+{
+#ifdef DEBUG
+    std::cout << "SegmentationExporter - BEGIN" << std::endl;
+#endif // DEBUG
+
+    if (m_Image->GetNumberOfComponentsPerPixel() != 1)
+    {
+        std::cerr << "ERROR: A Segmentation is written from a label map, not from a color image" << std::endl;
+        return false;
+    }
+
+    bool ret = false;
+    switch(m_PixelType)
+    {
+        case itk::ImageIOBase::UCHAR:
+        {
+            ret = InternalExport<unsigned char>();
+            break;
+        }
+        case itk::ImageIOBase::USHORT:
+        {
+            ret = InternalExport<unsigned short>();
+            break;
+        }
+        case itk::ImageIOBase::SHORT:
+        {
+            ret = InternalExport<signed short>();
+            break;
+        }
+        case itk::ImageIOBase::UINT:
+        {
+            ret = InternalExport<unsigned int>();
+            break;
+        }
+        default:
+        {
+            std::cerr << "ERROR: Unsupported output pixel type" << std::endl;
+            return false;
+        }
+    }
+
+#ifdef DEBUG
+    std::cout << "SegmentationExporter - END" << std::endl;
+#endif // DEBUG
+
+    return ret;
+}
+
+
+
+template<class TPixel> bool SegmentationExporter::InternalExport( void )
+{
+    //BEGIN Typedefs
+    typedef itk::Image<TPixel, Dimension>      OutputImageType;
+    //END Typedefs
+
+    typename OutputImageType::ConstPointer image = dynamic_cast<const OutputImageType*>(m_Image.GetPointer());
+    if(!image)
+    {
+        std::cerr << "Error Null Pointer In Exporter" << std::endl;
+        return false;
+    }
+
+    const ImageType::RegionType region = image->GetBufferedRegion();
+    const ImageType::SizeType size = region.GetSize();
+    const std::size_t nbSlices = size[2];
+    const std::size_t sliceSize = static_cast<std::size_t>(size[0]) * size[1];
+    const TPixel* buffer = image->GetBufferPointer();
+
+    std::cout << " * \033[1;34mExtracting segments\033[0m... " << std::endl;
+
+    //BEGIN Labels
+    // Labels of each slice. Label maps are made of runs of the same value,
+    // a value is looked up only when it differs from the previous one.
+    std::vector< std::vector<TPixel> > sliceLabels(nbSlices);
+    std::atomic<std::size_t> nextSlice(0);
+    Run(nbSlices, [&]()
+    {
+        for (std::size_t z = nextSlice++; z < nbSlices; z = nextSlice++)
+        {
+            std::set<TPixel> found;
+            const TPixel* p = buffer + z * sliceSize;
+            TPixel previous = 0;
+            for (std::size_t i = 0; i < sliceSize; i++)
+            {
+                if (p[i] != previous)
+                {
+                    previous = p[i];
+                    if (previous != 0)
+                        found.insert(previous);
+                }
+            }
+            sliceLabels[z].assign(found.begin(), found.end());
+        }
+    });
+
+    // Segments are numbered from 1 in the order of the labels, each one has
+    // a frame for every slice holding it.
+    std::map<TPixel, unsigned int> segmentOf;
+    for (std::size_t z = 0; z < nbSlices; z++)
+        for (std::size_t l = 0; l < sliceLabels[z].size(); l++)
+            segmentOf[sliceLabels[z][l]] = 0;
+    if (segmentOf.size() > maximumsegments)
+    {
+        std::cout << " * \033[1;34mExtracting segments\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: The label map has " << segmentOf.size() << " labels, at most " << maximumsegments << " segments can be written." << std::endl;
+        return false;
+    }
+    std::vector<TPixel> labels;
+    for (typename std::map<TPixel, unsigned int>::iterator it = segmentOf.begin(); it != segmentOf.end(); ++it)
+    {
+        it->second = static_cast<unsigned int>(labels.size());
+        labels.push_back(it->first);
+    }
+
+    std::vector< std::vector<std::size_t> > segmentSlices(labels.size());
+    for (std::size_t z = 0; z < nbSlices; z++)
+        for (std::size_t l = 0; l < sliceLabels[z].size(); l++)
+            segmentSlices[segmentOf[sliceLabels[z][l]]].push_back(z);
+
+    std::vector<unsigned long long> firstFrame(labels.size() + 1, 0);
+    for (std::size_t s = 0; s < labels.size(); s++)
+        firstFrame[s + 1] = firstFrame[s] + segmentSlices[s].size();
+    const unsigned long long nbFrames = firstFrame[labels.size()];
+    //END Labels
+
+    //BEGIN Frames
+    // BINARY frames are packed one after the other, without padding between
+    // them, the first pixel in the least significant bit. Each segment is
+    // packed in its own buffer, starting at the bit of its first frame
+    // within a byte, then merged: adjacent segments may share a byte.
+    const unsigned long long frameBits = sliceSize;
+    unsigned long long pixelDataBytes = (nbFrames * frameBits + 7) / 8;
+    pixelDataBytes += pixelDataBytes % 2;
+    if (pixelDataBytes >= 0xFFFFFFFEULL)
+    {
+        std::cout << " * \033[1;34mExtracting segments\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: The Segmentation is larger than 4 GB." << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> pixelData(static_cast<std::size_t>(pixelDataBytes), 0);
+    std::vector< std::vector<unsigned char> > segmentBits(labels.size());
+    std::atomic<unsigned int> nextSegment(0);
+    Run(static_cast<unsigned int>(labels.size()), [&]()
+    {
+        for (unsigned int s = nextSegment++; s < labels.size(); s = nextSegment++)
+        {
+            const TPixel label = labels[s];
+            const unsigned long long first = firstFrame[s] * frameBits;
+            unsigned long long bit = first % 8;
+            std::vector<unsigned char>& bits = segmentBits[s];
+            bits.assign(static_cast<std::size_t>((bit + segmentSlices[s].size() * frameBits + 7) / 8), 0);
+            for (std::size_t f = 0; f < segmentSlices[s].size(); f++)
+            {
+                const TPixel* p = buffer + segmentSlices[s][f] * sliceSize;
+                for (std::size_t i = 0; i < sliceSize; i++, bit++)
+                    if (p[i] == label)
+                        bits[bit >> 3] |= static_cast<unsigned char>(1 << (bit & 7));
+            }
+        }
+    });
+    for (std::size_t s = 0; s < labels.size(); s++)
+    {
+        unsigned char* out = &pixelData[0] + firstFrame[s] * frameBits / 8;
+        for (std::size_t i = 0; i < segmentBits[s].size(); i++)
+            out[i] |= segmentBits[s][i];
+        std::vector<unsigned char>().swap(segmentBits[s]);
+    }
+    //END Frames
+
+    std::cout << " * \033[1;34mExtracting segments\033[0m... \033[1;32mDONE\033[0m ("
+              << labels.size() << " segments, " << nbFrames << " of " << labels.size() * nbSlices << " frames)" << std::endl;
+    if (nbFrames == 0)
+    {
+        std::cerr << "ERROR: The label map has no label other than 0." << std::endl;
+        return false;
+    }
+
+
+
+    gdcm::DataSet dataSet;
+    gdcm::UIDGenerator uidGenerator;
+
+    //BEGIN Patient, study, series, frame of reference and equipment
+    for (DictionaryType::ConstIterator itr = m_Dict.Begin(); itr != m_Dict.End(); ++itr)
+    {
+        const MetaDataStringType* entryvalue = dynamic_cast<const MetaDataStringType*>( itr->second.GetPointer() );
+        if (!entryvalue)
+            continue;
+        bool copied = (itr->first.compare(0, 5, "0010|") == 0);
+        for (const char* const* tag = segmentationcopiedtags; *tag && !copied; ++tag)
+            copied = (itr->first == *tag);
+        if (copied)
+            tools::SetDictionaryEntry(dataSet, itr->first, entryvalue->GetMetaDataObjectValue());
+    }
+
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0010), "");                        // Patient's Name
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0020), "");                        // Patient ID
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0030), "");                        // Patient's Birth Date
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0010, 0x0040), "");                        // Patient's Sex
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0020), "");                        // Study Date
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0030), "");                        // Study Time
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0050), "");                        // Accession Number
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0090), "");                        // Referring Physician's Name
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0010), "");                        // Study ID
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x000d), uidGenerator.Generate());   // Study Instance UID
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x000e), uidGenerator.Generate());   // Series Instance UID
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0011), "");                        // Series Number
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x0052), uidGenerator.Generate());   // Frame of Reference UID
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0020, 0x1040), "");                        // Position Reference Indicator
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x0070), "");                        // Manufacturer
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0008, 0x1090), "nifti2dicom");             // Manufacturer's Model Name
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0018, 0x1000), defaultdeviceserialnumber); // Device Serial Number
+    tools::SetStringIfMissing(dataSet, gdcm::Tag(0x0018, 0x1020), GetInternalVersion());      // Software Versions
+    //END Patient, study, series, frame of reference and equipment
+
+    //BEGIN SOP Common, Segmentation Series and General Image
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0016), segmentationsopclassuid);            // SOP Class UID
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0018), uidGenerator.Generate());            // SOP Instance UID
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0060), "SEG");                              // Modality
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0008), "DERIVED\\PRIMARY");                 // Image Type
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0023), tools::Date::DateStr());             // Content Date
+    tools::SetString(dataSet, gdcm::Tag(0x0008, 0x0033), tools::Date::TimeStr());             // Content Time
+    tools::SetString(dataSet, gdcm::Tag(0x0020, 0x0013), "1");                                // Instance Number
+    tools::SetString(dataSet, gdcm::Tag(0x0070, 0x0080), defaultcontentlabel);                // Content Label
+    tools::SetString(dataSet, gdcm::Tag(0x0070, 0x0081), "");                                 // Content Description
+    tools::SetString(dataSet, gdcm::Tag(0x0070, 0x0084), "");                                 // Content Creator's Name
+    tools::SetString(dataSet, gdcm::Tag(0x0028, 0x2110), "00");                               // Lossy Image Compression
+    //END SOP Common, Segmentation Series and General Image
+
+    //BEGIN Image Pixel and Segmentation Image
+    gdcm::Attribute<0x0028, 0x0002> samplesPerPixel;
+    samplesPerPixel.SetValue(1);
+    dataSet.Replace(samplesPerPixel.GetAsDataElement());
+    tools::SetString(dataSet, gdcm::Tag(0x0028, 0x0004), "MONOCHROME2");                      // Photometric Interpretation
+    gdcm::Attribute<0x0028, 0x0010> rows;
+    rows.SetValue(static_cast<unsigned short>(size[1]));
+    dataSet.Replace(rows.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0011> columns;
+    columns.SetValue(static_cast<unsigned short>(size[0]));
+    dataSet.Replace(columns.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0100> bitsAllocated;
+    bitsAllocated.SetValue(1);
+    dataSet.Replace(bitsAllocated.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0101> bitsStored;
+    bitsStored.SetValue(1);
+    dataSet.Replace(bitsStored.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0102> highBit;
+    highBit.SetValue(0);
+    dataSet.Replace(highBit.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0103> pixelRepresentation;
+    pixelRepresentation.SetValue(0);
+    dataSet.Replace(pixelRepresentation.GetAsDataElement());
+    gdcm::Attribute<0x0028, 0x0008> numberOfFrames;
+    numberOfFrames.SetValue(static_cast<int>(nbFrames));
+    dataSet.Replace(numberOfFrames.GetAsDataElement());
+    tools::SetString(dataSet, gdcm::Tag(0x0062, 0x0001), "BINARY");                           // Segmentation Type
+
+    gdcm::SmartPointer<gdcm::SequenceOfItems> segments = new gdcm::SequenceOfItems;
+    segments->SetLengthToUndefined();
+    for (std::size_t s = 0; s < labels.size(); s++)
+    {
+        gdcm::DataSet segment;
+        gdcm::Attribute<0x0062, 0x0004> segmentNumber;
+        segmentNumber.SetValue(static_cast<unsigned short>(s + 1));
+        segment.Replace(segmentNumber.GetAsDataElement());
+        std::ostringstream segmentLabel;
+        segmentLabel << "Label " << static_cast<long long>(labels[s]);
+        tools::SetString(segment, gdcm::Tag(0x0062, 0x0005), segmentLabel.str());             // Segment Label
+        tools::SetString(segment, gdcm::Tag(0x0062, 0x0008), "MANUAL");                       // Segment Algorithm Type
+        tools::SetItem(segment, gdcm::Tag(0x0062, 0x0003), CodeItem("85756007", "SCT", "Tissue")); // Segmented Property Category Code Sequence
+        tools::SetItem(segment, gdcm::Tag(0x0062, 0x000f), CodeItem("85756007", "SCT", "Tissue")); // Segmented Property Type Code Sequence
+        tools::AddItem(*segments, segment);
+    }
+    tools::SetSequence(dataSet, gdcm::Tag(0x0062, 0x0002), segments);                         // Segment Sequence
+    //END Image Pixel and Segmentation Image
+
+    //BEGIN Multi-frame Dimension
+    // Frames are indexed by segment, then by position
+    const std::string dimensionOrganizationUID = uidGenerator.Generate();
+    gdcm::DataSet organization;
+    tools::SetString(organization, gdcm::Tag(0x0020, 0x9164), dimensionOrganizationUID);
+    tools::SetItem(dataSet, gdcm::Tag(0x0020, 0x9221), organization);                         // Dimension Organization Sequence
+
+    gdcm::SmartPointer<gdcm::SequenceOfItems> dimensions = new gdcm::SequenceOfItems;
+    dimensions->SetLengthToUndefined();
+    const gdcm::Tag dimensionPointers[2][2] = {
+        { gdcm::Tag(0x0062, 0x000b), gdcm::Tag(0x0062, 0x000a) }, // Referenced Segment Number in Segment Identification Sequence
+        { gdcm::Tag(0x0020, 0x0032), gdcm::Tag(0x0020, 0x9113) }  // Image Position (Patient) in Plane Position Sequence
+    };
+    for (unsigned int d = 0; d < 2; d++)
+    {
+        gdcm::DataSet dimension;
+        tools::SetString(dimension, gdcm::Tag(0x0020, 0x9164), dimensionOrganizationUID);
+        gdcm::Attribute<0x0020, 0x9165> indexPointer;
+        indexPointer.SetValue(dimensionPointers[d][0]);
+        dimension.Replace(indexPointer.GetAsDataElement());
+        gdcm::Attribute<0x0020, 0x9167> groupPointer;
+        groupPointer.SetValue(dimensionPointers[d][1]);
+        dimension.Replace(groupPointer.GetAsDataElement());
+        tools::AddItem(*dimensions, dimension);
+    }
+    tools::SetSequence(dataSet, gdcm::Tag(0x0020, 0x9222), dimensions);                       // Dimension Index Sequence
+    //END Multi-frame Dimension
+
+    //BEGIN Multi-frame Functional Groups
+    const ImageType::SpacingType spacing = image->GetSpacing();
+    const ImageType::DirectionType direction = image->GetDirection();
+
+    gdcm::DataSet shared;
+    gdcm::DataSet measures;
+    gdcm::Attribute<0x0028, 0x0030> pixelSpacing;
+    pixelSpacing.SetValue(spacing[1], 0);
+    pixelSpacing.SetValue(spacing[0], 1);
+    measures.Replace(pixelSpacing.GetAsDataElement());
+    gdcm::Attribute<0x0018, 0x0050> sliceThickness;
+    sliceThickness.SetValue(spacing[2]);
+    measures.Replace(sliceThickness.GetAsDataElement());
+    gdcm::Attribute<0x0018, 0x0088> spacingBetweenSlices;
+    spacingBetweenSlices.SetValue(spacing[2]);
+    measures.Replace(spacingBetweenSlices.GetAsDataElement());
+    tools::SetItem(shared, gdcm::Tag(0x0028, 0x9110), measures);                              // Pixel Measures Sequence
+    gdcm::DataSet orientation;
+    gdcm::Attribute<0x0020, 0x0037> imageOrientation;
+    for (unsigned int j = 0; j < 3; j++)
+    {
+        imageOrientation.SetValue(direction[j][0], j);
+        imageOrientation.SetValue(direction[j][1], j + 3);
+    }
+    orientation.Replace(imageOrientation.GetAsDataElement());
+    tools::SetItem(shared, gdcm::Tag(0x0020, 0x9116), orientation);                           // Plane Orientation Sequence
+    tools::SetItem(dataSet, gdcm::Tag(0x5200, 0x9229), shared);                               // Shared Functional Groups Sequence
+
+    // Positions and numbers are those of the slices in the whole volume
+    // (see FiltersArgs::slicestart and FiltersArgs::crop)
+    const ImageType::IndexType firstIndex = image->GetLargestPossibleRegion().GetIndex();
+    gdcm::SmartPointer<gdcm::SequenceOfItems> perFrame = new gdcm::SequenceOfItems;
+    perFrame->SetLengthToUndefined();
+    for (std::size_t s = 0; s < labels.size(); s++)
+    {
+        for (std::size_t f = 0; f < segmentSlices[s].size(); f++)
+        {
+            const std::size_t z = segmentSlices[s][f];
+            gdcm::DataSet frame;
+
+            gdcm::DataSet content;
+            gdcm::Attribute<0x0020, 0x9157> indexValues;
+            const unsigned int values[2] = { static_cast<unsigned int>(s + 1), static_cast<unsigned int>(firstIndex[2] + z + 1) };
+            indexValues.SetValues(values, 2, true);
+            content.Replace(indexValues.GetAsDataElement());
+            tools::SetItem(frame, gdcm::Tag(0x0020, 0x9111), content);                        // Frame Content Sequence
+
+            ImageType::IndexType index = firstIndex;
+            index[2] += z;
+            ImageType::PointType position;
+            image->TransformIndexToPhysicalPoint(index, position);
+            gdcm::DataSet plane;
+            gdcm::Attribute<0x0020, 0x0032> imagePosition;
+            for (unsigned int j = 0; j < 3; j++)
+                imagePosition.SetValue(position[j], j);
+            plane.Replace(imagePosition.GetAsDataElement());
+            tools::SetItem(frame, gdcm::Tag(0x0020, 0x9113), plane);                          // Plane Position Sequence
+
+            gdcm::DataSet identification;
+            gdcm::Attribute<0x0062, 0x000b> referencedSegment;
+            referencedSegment.SetValue(static_cast<unsigned short>(s + 1));
+            identification.Replace(referencedSegment.GetAsDataElement());
+            tools::SetItem(frame, gdcm::Tag(0x0062, 0x000a), identification);                 // Segment Identification Sequence
+
+            tools::AddItem(*perFrame, frame);
+        }
+    }
+    tools::SetSequence(dataSet, gdcm::Tag(0x5200, 0x9230), perFrame);                         // Per-frame Functional Groups Sequence
+    //END Multi-frame Functional Groups
+
+    gdcm::DataElement pixelDataElement(gdcm::Tag(0x7fe0, 0x0010));
+    pixelDataElement.SetVR(gdcm::VR::OB);
+    pixelDataElement.SetByteValue(reinterpret_cast<const char*>(&pixelData[0]), static_cast<uint32_t>(pixelData.size()));
+    dataSet.Replace(pixelDataElement);
+    std::vector<unsigned char>().swap(pixelData);
+
+
+
+    //BEGIN Writer
+    const std::string name = m_OutputArgs.prefix + "seg" + m_OutputArgs.suffix;
+    std::unique_ptr<SliceWriter> writer( SliceWriter::New(m_OutputArgs) );
+    std::cout << " * \033[1;34mWriting\033[0m... " << std::endl;
+    if (!writer->Open())
+    {
+        std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        return false;
+    }
+
+    if (!tools::WriteDataSet(dataSet, writer->GetSliceFileName(name)) || !writer->SliceWritten(name) || !writer->Close())
+    {
+        std::cout << " * \033[1;34mWriting\033[0m... \033[1;31mFAIL\033[0m" << std::endl;
+        std::cerr << "ERROR: Cannot write " << name << std::endl;
+        return false;
+    }
+    std::cout << " * \033[1;34mWriting\033[0m... \033[1;32mDONE\033[0m" << std::endl;
+    //END Writer
+
+    return true;
+}
+
+} // namespace n2d
@@ -0,0 +1,80 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DSEGMENTATIONEXPORTER_H
+#define N2DSEGMENTATIONEXPORTER_H
+
+#include "n2dDefsCommandLineArgsStructs.h"
+#include "n2dDefsImage.h"
+#include "n2dDefsMetadata.h"
+
+namespace n2d {
+
+//BEGIN class n2d::SegmentationExporter
+/*!
+ * \brief Writes the filtered image, a label map, as a DICOM Segmentation
+ *
+ * Each value of the image other than 0 is a segment. The Segmentation is a
+ * single multi-frame instance with BINARY frames, 1 bit per pixel, one
+ * frame per segment and slice holding that segment: empty frames are not
+ * written.
+ *
+ * The patient, study, series, frame of reference and equipment tags are
+ * copied from the dictionary, so that the Segmentation belongs to the
+ * study of the reference header (see n2d::HeaderImporter).
+ *
+ * The labels found in each slice are collected by a pool of threads, one
+ * block of slices each, then the frames of the segments are packed in
+ * parallel, one segment at a time per thread.
+ *
+ * The file is written to the destination chosen by the output arguments
+ * (see SliceWriter::New()), with the name OutputArgs::prefix + "seg" +
+ * OutputArgs::suffix.
+ */
+class SegmentationExporter
+{
+public:
+    SegmentationExporter(const OutputArgs& outputArgs, ImageType::ConstPointer image, PixelType pixelType, const DictionaryType& dict) :
+            m_OutputArgs(outputArgs),
+            m_Image(image),
+            m_PixelType(pixelType),
+            m_Dict(dict)
+    {
+    }
+
+    ~SegmentationExporter() {}
+
+    bool Export( void );
+
+    static const unsigned int maximumsegments = 65535; //!< Segment Number is US
+
+private:
+    template<class TPixel> bool InternalExport( void );
+
+    const OutputArgs& m_OutputArgs;
+    ImageType::ConstPointer m_Image;
+    PixelType m_PixelType;
+    const DictionaryType& m_Dict;
+};
+//END class n2d::SegmentationExporter
+
+} // namespace n2d
+
+#endif // N2DSEGMENTATIONEXPORTER_H
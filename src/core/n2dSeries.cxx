@@ -148,8 +148,14 @@ bool Series::Update()
 
 
 //BEGIN (0020,0052) Frame of Reference UID
-    gdcm::UIDGenerator uid;
-    std::string frameOfReferenceUID = uid.Generate();
+    // Kept if restored from a previous conversion
+    std::string frameOfReferenceUID;
+    itk::ExposeMetaData<std::string>(m_Dict, frameofreferenceuidtag, frameOfReferenceUID);
+    if (frameOfReferenceUID.empty())
+    {
+        gdcm::UIDGenerator uid;
+        frameOfReferenceUID = uid.Generate();
+    }
     itk::EncapsulateMetaData<std::string>(m_Dict, frameofreferenceuidtag, frameOfReferenceUID);
 //END (0020,0052) Frame of Reference UID
 
@@ -0,0 +1,332 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dSliceWriter.h"
+
+#include <itksys/SystemTools.hxx>
+#include <iostream>
+#include <cstdio>
+
+
+namespace n2d {
+
+SliceWriter* SliceWriter::New( const OutputArgs& outputArgs )
+{
+    if (!outputArgs.storescu.empty())
+        return new StoreSliceWriter(outputArgs);
+    if (!outputArgs.stowrs.empty())
+        return new StowSliceWriter(outputArgs);
+    if (outputArgs.outputdirectory == "-" && outputArgs.streamformat == "length-prefixed")
+        return new FramedStreamSliceWriter();
+    if (!outputArgs.outputarchive.empty() || outputArgs.outputdirectory == "-")
+        return new ArchiveSliceWriter(outputArgs);
+    // Resumed conversions need to know when each slice is on disk
+    if (outputArgs.writequeue > 0 && !outputArgs.resume)
+        return new AsyncDirectorySliceWriter(outputArgs);
+    return new DirectorySliceWriter(outputArgs);
+}
+
+
+
+bool SliceWriter::MakeParentDirectory( const std::string& fileName )
+{
+    const std::string directory = itksys::SystemTools::GetFilenamePath( fileName );
+    if (directory.empty() || m_Directories.count(directory))
+        return true;
+
+    if (!MakeDirectory(directory))
+        return false;
+    m_Directories.insert(directory);
+    return true;
+}
+
+
+bool SliceWriter::MakeDirectory( const std::string& directory )
+{
+    // The directories that do not exist yet are new entries of their parent
+    std::vector<std::string> created;
+    for (std::string missing = directory; !missing.empty() && !itksys::SystemTools::FileIsDirectory(missing);
+         missing = itksys::SystemTools::GetFilenamePath(missing))
+        created.push_back(missing);
+
+    if (!itksys::SystemTools::MakeDirectory( directory.c_str() ))
+    {
+        std::cerr << "ERROR: Cannot create directory \"" << directory << "\"." << std::endl;
+        return false;
+    }
+    m_NewDirectories.insert(created.begin(), created.end());
+    return true;
+}
+
+
+bool SliceWriter::SyncDirectories( const std::string& fileName )
+{
+    std::string directory = itksys::SystemTools::GetFilenamePath( fileName );
+    if (!tools::SyncDirectory(directory.empty() ? "." : directory))
+        return false;
+    while (m_NewDirectories.erase(directory))
+    {
+        directory = itksys::SystemTools::GetFilenamePath( directory );
+        if (!tools::SyncDirectory(directory.empty() ? "." : directory))
+            return false;
+    }
+    return true;
+}
+
+
+
+bool SliceWriter::SyncWrittenFiles( const std::string& directory, const std::vector<std::string>& fileNames )
+{
+    std::set<std::string> changed;
+    for (std::size_t i = 0; i < fileNames.size(); ++i)
+        changed.insert(itksys::SystemTools::GetFilenamePath( fileNames[i] ));
+    for (std::set<std::string>::const_iterator it = m_NewDirectories.begin(); it != m_NewDirectories.end(); ++it)
+        changed.insert(itksys::SystemTools::GetFilenamePath( *it ));
+    m_NewDirectories.clear();
+
+    std::vector<std::string> directories;
+    for (std::set<std::string>::const_iterator it = changed.begin(); it != changed.end(); ++it)
+        directories.push_back(it->empty() ? "." : *it);
+    return tools::SyncFiles(directory, fileNames, directories);
+}
+
+
+
+//BEGIN DirectorySliceWriter
+bool DirectorySliceWriter::Open( void )
+{
+    // Create directory if it does not exist yet
+    return MakeDirectory( m_OutputArgs.outputdirectory );
+}
+
+
+std::string DirectorySliceWriter::GetSliceFileName( const std::string& name )
+{
+    const std::string fileName = m_OutputArgs.outputdirectory + "/" + name;
+    // If this fails, the DICOM IO reports that the file cannot be written
+    MakeParentDirectory(fileName);
+    return fileName;
+}
+
+
+bool DirectorySliceWriter::SliceWritten( const std::string& name )
+{
+    // The new entry of the slice in its directory is flushed too
+    if (m_OutputArgs.sync == "file")
+        return tools::SyncFile(GetSliceFileName(name)) && SyncDirectories(GetSliceFileName(name));
+    if (m_OutputArgs.sync == "series")
+        m_WrittenFiles.push_back(GetSliceFileName(name));
+    return true;
+}
+
+
+bool DirectorySliceWriter::Close( void )
+{
+    if (m_OutputArgs.sync == "series")
+        return SyncWrittenFiles(m_OutputArgs.outputdirectory, m_WrittenFiles);
+    return true;
+}
+//END DirectorySliceWriter
+
+
+
+//BEGIN MemorySliceWriter
+bool MemorySliceWriter::Open( void )
+{
+    if (!m_MemoryFile.IsValid())
+    {
+        std::cerr << "ERROR: Cannot create a temporary memory file." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+std::string MemorySliceWriter::GetSliceFileName( const std::string& /*name*/ )
+{
+    return m_MemoryFile.GetFileName();
+}
+
+
+bool MemorySliceWriter::SliceWritten( const std::string& name )
+{
+    if (!m_MemoryFile.Read(m_Buffer))
+    {
+        std::cerr << "ERROR: Cannot read encoded slice \"" << name << "\"." << std::endl;
+        return false;
+    }
+    return WriteSlice(name, m_Buffer.empty() ? NULL : &m_Buffer[0], m_Buffer.size());
+}
+//END MemorySliceWriter
+
+
+
+//BEGIN ArchiveSliceWriter
+bool ArchiveSliceWriter::Open( void )
+{
+    if (!MemorySliceWriter::Open())
+        return false;
+
+    m_Stream = (m_OutputArgs.outputdirectory == "-");
+    if (m_Stream)
+        return m_Archive.Open(tools::StandardOutput(), m_OutputArgs.streamformat == "tar.zst");
+
+    const std::string& fileName = m_OutputArgs.outputarchive;
+    const bool compress = fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".zst") == 0;
+    return m_Archive.Open(fileName, compress);
+}
+
+
+bool ArchiveSliceWriter::WriteSlice( const std::string& name, const char* data, std::size_t size )
+{
+    if (!m_Archive.AddFile(name, data, size))
+        return false;
+    // Syncing makes no sense on a pipe
+    if (!m_Stream && m_OutputArgs.sync == "file")
+        return m_Archive.Sync();
+    return !m_Stream || m_Archive.Flush();
+}
+
+
+bool ArchiveSliceWriter::Close( void )
+{
+    if (!m_Archive.Close())
+        return false;
+    if (!m_Stream && m_OutputArgs.sync != "none")
+    {
+        const std::vector<std::string> files(1, m_OutputArgs.outputarchive);
+        std::string directory = itksys::SystemTools::GetFilenamePath(m_OutputArgs.outputarchive);
+        return tools::SyncFiles(directory.empty() ? "." : directory, files, std::vector<std::string>());
+    }
+    return true;
+}
+//END ArchiveSliceWriter
+
+
+
+//BEGIN AsyncDirectorySliceWriter
+bool AsyncDirectorySliceWriter::Open( void )
+{
+    // Create directory if it does not exist yet
+    return MakeDirectory( m_OutputArgs.outputdirectory ) && MemorySliceWriter::Open() && m_Writer.Open();
+}
+
+
+bool AsyncDirectorySliceWriter::WriteSlice( const std::string& name, const char* data, std::size_t size )
+{
+    const std::string fileName = m_OutputArgs.outputdirectory + "/" + name;
+    if (!MakeParentDirectory(fileName))
+        return false;
+    if (m_OutputArgs.sync == "series" || m_OutputArgs.sync == "file")
+        m_WrittenFiles.push_back(fileName);
+    return m_Writer.Write(fileName, data, size);
+}
+
+
+bool AsyncDirectorySliceWriter::Close( void )
+{
+    if (!m_Writer.Close())
+        return false;
+    if (m_OutputArgs.sync == "series")
+        return SyncWrittenFiles(m_OutputArgs.outputdirectory, m_WrittenFiles);
+    if (m_OutputArgs.sync == "file")
+    {
+        // The slices were flushed by the writer threads, the new entries of
+        // their directories are flushed once all of them are written.
+        std::set<std::string> directories;
+        for (std::size_t i = 0; i < m_WrittenFiles.size(); ++i)
+            if (directories.insert(itksys::SystemTools::GetFilenamePath(m_WrittenFiles[i])).second && !SyncDirectories(m_WrittenFiles[i]))
+                return false;
+    }
+    return true;
+}
+//END AsyncDirectorySliceWriter
+
+
+
+//BEGIN FramedStreamSliceWriter
+bool FramedStreamSliceWriter::Open( void )
+{
+    return MemorySliceWriter::Open() && tools::StandardOutput() != NULL;
+}
+
+
+bool FramedStreamSliceWriter::WriteSlice( const std::string& /*name*/, const char* data, std::size_t size )
+{
+    unsigned char length[8];
+    for (int i = 0; i < 8; ++i)
+        length[i] = static_cast<unsigned char>((static_cast<unsigned long long>(size) >> (8 * (7 - i))) & 0xff);
+
+    std::FILE* out = tools::StandardOutput();
+    return std::fwrite(length, 1, 8, out) == 8 &&
+           std::fwrite(data, 1, size, out) == size &&
+           std::fflush(out) == 0;
+}
+
+
+bool FramedStreamSliceWriter::Close( void )
+{
+    return std::fflush(tools::StandardOutput()) == 0;
+}
+//END FramedStreamSliceWriter
+
+
+
+//BEGIN StoreSliceWriter
+bool StoreSliceWriter::Open( void )
+{
+    return MemorySliceWriter::Open() && m_StoreSCU.Open();
+}
+
+
+bool StoreSliceWriter::WriteSlice( const std::string& name, const char* data, std::size_t size )
+{
+    return m_StoreSCU.Store(name, data, size);
+}
+
+
+bool StoreSliceWriter::Close( void )
+{
+    return m_StoreSCU.Close();
+}
+//END StoreSliceWriter
+
+
+
+//BEGIN StowSliceWriter
+bool StowSliceWriter::Open( void )
+{
+    return MemorySliceWriter::Open() && m_StowClient.Open();
+}
+
+
+bool StowSliceWriter::WriteSlice( const std::string& name, const char* data, std::size_t size )
+{
+    return m_StowClient.Store(name, data, size);
+}
+
+
+bool StowSliceWriter::Close( void )
+{
+    return m_StowClient.Close();
+}
+//END StowSliceWriter
+
+} // namespace n2d
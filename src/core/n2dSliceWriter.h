@@ -0,0 +1,318 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DSLICEWRITER_H
+#define N2DSLICEWRITER_H
+
+#include "n2dDefsCommandLineArgsStructs.h"
+#include "n2dToolsMemoryFile.h"
+#include "n2dToolsTar.h"
+#include "n2dToolsAsyncFileWriter.h"
+#include "n2dToolsSync.h"
+#include "n2dToolsStoreSCU.h"
+#include "n2dToolsStowClient.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstddef>
+
+namespace n2d {
+
+//BEGIN class n2d::SliceWriter
+/*!
+ * \brief Destination of the DICOM slices written by n2d::OutputExporter
+ *
+ * The DICOM IO writes every slice to the file name returned by
+ * GetSliceFileName(), SliceWritten() is then called to let the writer move
+ * the encoded slice to its final destination.
+ *
+ * Writers honour the durability policy in OutputArgs::sync: "file" flushes
+ * every slice to stable storage as soon as it is written, "series" flushes
+ * everything once in Close().
+ */
+class SliceWriter
+{
+public:
+    virtual ~SliceWriter() {}
+
+    virtual bool Open( void ) = 0;
+
+/*!
+ * \brief Get the file name where the DICOM IO should write a slice.
+ *
+ * \param name Slice name, built from prefix, digits and suffix.
+ */
+    virtual std::string GetSliceFileName( const std::string& name ) = 0;
+
+/*!
+ * \brief Notify that the slice was written by the DICOM IO.
+ *
+ * \return true on success.
+ */
+    virtual bool SliceWritten( const std::string& name ) = 0;
+
+    virtual bool Close( void ) = 0;
+
+/*!
+ * \brief Create the writer requested by the output arguments.
+ */
+    static SliceWriter* New( const OutputArgs& outputArgs );
+
+protected:
+/*!
+ * \brief Create the directory containing a file, unless it was already created.
+ *
+ * Slice names can contain subdirectories (see OutputArgs::layout), the
+ * directories created are cached so that each one is created only once.
+ */
+    bool MakeParentDirectory( const std::string& fileName );
+
+/*!
+ * \brief Create a directory and its missing parents.
+ *
+ * The directories created are remembered for SyncDirectories().
+ */
+    bool MakeDirectory( const std::string& directory );
+
+/*!
+ * \brief Flush the directory containing a file that was just written.
+ *
+ * The directories created for the file by MakeDirectory() are new entries
+ * of their parents, which are flushed too, only once for each directory.
+ */
+    bool SyncDirectories( const std::string& fileName );
+
+/*!
+ * \brief Flush all the files written in the output directory at once.
+ *
+ * The directories containing the files and the parents of the directories
+ * created by MakeDirectory() are flushed with them (see tools::SyncFiles()).
+ */
+    bool SyncWrittenFiles( const std::string& directory, const std::vector<std::string>& fileNames );
+
+private:
+    std::set<std::string> m_Directories;
+    std::set<std::string> m_NewDirectories; //!< Created, their parent not flushed yet
+};
+//END class n2d::SliceWriter
+
+
+
+//BEGIN class n2d::DirectorySliceWriter
+/*!
+ * \brief Writes every slice in a separate file in the output directory
+ */
+class DirectorySliceWriter : public SliceWriter
+{
+public:
+    DirectorySliceWriter(const OutputArgs& outputArgs) :
+            m_OutputArgs(outputArgs)
+    {
+    }
+
+    virtual bool Open( void );
+    virtual std::string GetSliceFileName( const std::string& name );
+    virtual bool SliceWritten( const std::string& name );
+    virtual bool Close( void );
+
+private:
+    const OutputArgs& m_OutputArgs;
+    std::vector<std::string> m_WrittenFiles; //!< Files to be flushed in Close()
+};
+//END class n2d::DirectorySliceWriter
+
+
+
+//BEGIN class n2d::MemorySliceWriter
+/*!
+ * \brief Base class for writers that get every slice encoded in memory
+ *
+ * The DICOM IO writes the slice to a tools::MemoryFile, the encoded slice
+ * is then passed to WriteSlice().
+ */
+class MemorySliceWriter : public SliceWriter
+{
+public:
+    virtual bool Open( void );
+    virtual std::string GetSliceFileName( const std::string& name );
+    virtual bool SliceWritten( const std::string& name );
+
+protected:
+/*!
+ * \brief Write an encoded slice.
+ *
+ * \return true on success.
+ */
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size ) = 0;
+
+private:
+    tools::MemoryFile m_MemoryFile;
+    std::vector<char> m_Buffer;
+};
+//END class n2d::MemorySliceWriter
+
+
+
+//BEGIN class n2d::ArchiveSliceWriter
+/*!
+ * \brief Streams every slice into a single tar archive
+ *
+ * No file is created for each slice. Archives whose name ends with ".zst"
+ * are compressed. If the output directory is "-" the archive is written to
+ * the standard output and flushed after every slice.
+ */
+class ArchiveSliceWriter : public MemorySliceWriter
+{
+public:
+    ArchiveSliceWriter(const OutputArgs& outputArgs) :
+            m_OutputArgs(outputArgs),
+            m_Stream(false)
+    {
+    }
+
+    virtual bool Open( void );
+    virtual bool Close( void );
+
+protected:
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size );
+
+private:
+    const OutputArgs& m_OutputArgs;
+    tools::TarWriter m_Archive;
+    bool m_Stream;
+};
+//END class n2d::ArchiveSliceWriter
+
+
+
+//BEGIN class n2d::AsyncDirectorySliceWriter
+/*!
+ * \brief Writes every slice in a separate file keeping several writes in flight
+ *
+ * Slices are encoded in memory and handed to a tools::AsyncFileWriter, so
+ * that the next slice can be encoded while the previous ones are written.
+ */
+class AsyncDirectorySliceWriter : public MemorySliceWriter
+{
+public:
+    AsyncDirectorySliceWriter(const OutputArgs& outputArgs) :
+            m_OutputArgs(outputArgs),
+            m_Writer(outputArgs.writequeue, outputArgs.sync == "file")
+    {
+    }
+
+    virtual bool Open( void );
+    virtual bool Close( void );
+
+protected:
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size );
+
+private:
+    const OutputArgs& m_OutputArgs;
+    tools::AsyncFileWriter m_Writer;
+    std::vector<std::string> m_WrittenFiles; //!< Files flushed in Close() ("series"), or whose directories are ("file")
+};
+//END class n2d::AsyncDirectorySliceWriter
+
+
+
+//BEGIN class n2d::FramedStreamSliceWriter
+/*!
+ * \brief Writes every slice to the standard output as a length-prefixed frame
+ *
+ * Each frame is a 64 bit big endian length followed by a DICOM Part 10
+ * object of that length.
+ */
+class FramedStreamSliceWriter : public MemorySliceWriter
+{
+public:
+    FramedStreamSliceWriter() {}
+
+    virtual bool Open( void );
+    virtual bool Close( void );
+
+protected:
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size );
+};
+//END class n2d::FramedStreamSliceWriter
+
+
+
+//BEGIN class n2d::StoreSliceWriter
+/*!
+ * \brief Sends every slice to a DICOM Storage SCP
+ *
+ * Slices are encoded in memory and handed to a tools::StoreSCU, that sends
+ * them on a single association while the next slices are encoded. No file
+ * is written.
+ */
+class StoreSliceWriter : public MemorySliceWriter
+{
+public:
+    StoreSliceWriter(const OutputArgs& outputArgs) :
+            m_StoreSCU(outputArgs.storescu, outputArgs.calledaet, outputArgs.callingaet,
+                       outputArgs.writequeue > 0 ? outputArgs.writequeue : 16, outputArgs.networktimeout)
+    {
+    }
+
+    virtual bool Open( void );
+    virtual bool Close( void );
+
+protected:
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size );
+
+private:
+    tools::StoreSCU m_StoreSCU;
+};
+//END class n2d::StoreSliceWriter
+
+
+
+//BEGIN class n2d::StowSliceWriter
+/*!
+ * \brief Posts the slices to a DICOMweb STOW-RS endpoint
+ *
+ * Slices are encoded in memory and handed to a tools::StowClient, that
+ * posts them in batches while the next slices are encoded. No file is
+ * written.
+ */
+class StowSliceWriter : public MemorySliceWriter
+{
+public:
+    StowSliceWriter(const OutputArgs& outputArgs) :
+            m_StowClient(outputArgs.stowrs, outputArgs.stowbatch, outputArgs.stowconnections, outputArgs.networktimeout)
+    {
+    }
+
+    virtual bool Open( void );
+    virtual bool Close( void );
+
+protected:
+    virtual bool WriteSlice( const std::string& name, const char* data, std::size_t size );
+
+private:
+    tools::StowClient m_StowClient;
+};
+//END class n2d::StowSliceWriter
+
+} // namespace n2d
+
+#endif // N2DSLICEWRITER_H
@@ -0,0 +1,556 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsAsyncFileWriter.h"
+#include "n2dToolsSync.h"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+
+#ifndef _WIN32
+ #include <unistd.h>
+#else
+ #include <io.h>
+ #include <sys/stat.h>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+
+// Number of written files closed together
+const std::size_t closebatch = 32;
+
+// Maximum number of threads used when io_uring is not available
+const unsigned int maxthreads = 64;
+
+
+// Flags and mode of the files written
+#ifndef _WIN32
+const int openflags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+const int openmode = 0644;
+#endif
+
+
+// Open a file for writing and reserve its final size, so that the file
+// system does not have to extend it while the data is written.
+int OpenFile( const std::string& fileName, std::size_t size )
+{
+#ifndef _WIN32
+    int fd = open(fileName.c_str(), openflags, openmode);
+ #ifdef __linux__
+    // Best effort, not all the file systems support it.
+    if (fd >= 0 && size > 0)
+        fallocate(fd, 0, 0, static_cast<off_t>(size));
+ #else
+    (void)size;
+ #endif
+    return fd;
+#else
+    (void)size;
+    return _open(fileName.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#endif
+}
+
+
+bool CloseFile( int fd )
+{
+#ifndef _WIN32
+    return close(fd) == 0;
+#else
+    return _close(fd) == 0;
+#endif
+}
+
+} // namespace
+
+
+
+AsyncFileWriter::AsyncFileWriter( unsigned int depth, bool syncFiles ) :
+        m_Depth(depth > 0 ? depth : 1),
+        m_SyncFiles(syncFiles),
+        m_Error(false),
+        m_Open(false)
+#ifdef N2D_HAVE_LIBURING
+        , m_InFlight(0)
+        , m_RingOpen(true)
+#else
+        , m_Done(false)
+#endif
+{
+}
+
+
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    if (m_Open)
+        Close();
+}
+
+
+
+const char* AsyncFileWriter::GetBackendName( void )
+{
+#ifdef N2D_HAVE_LIBURING
+    return "io_uring";
+#else
+    return "threads";
+#endif
+}
+
+
+
+#ifdef N2D_HAVE_LIBURING
+
+//BEGIN io_uring backend
+bool AsyncFileWriter::Open( void )
+{
+    // Room for a full batch of close requests besides the writes and their
+    // preallocations
+    const int ret = io_uring_queue_init(2 * m_Depth + closebatch, &m_Ring, 0);
+    if (ret < 0)
+    {
+        std::cerr << "ERROR: Cannot initialize io_uring: " << std::strerror(-ret) << std::endl;
+        return false;
+    }
+    m_Open = true;
+    return true;
+}
+
+
+bool AsyncFileWriter::Write( const std::string& fileName, const char* data, std::size_t size )
+{
+    if (m_Error)
+        return false;
+
+    Job* job = new Job;
+    job->fileName = fileName;
+    job->data.assign(data, data + size);
+    job->written = 0;
+    job->fd = -1;
+    job->stage = Opening;
+
+    while (m_InFlight >= m_Depth)
+    {
+        if (!Reap(true))
+        {
+            m_Error = true;
+            break;
+        }
+    }
+    return SubmitOpen(job) && !m_Error;
+}
+
+
+struct io_uring_sqe* AsyncFileWriter::GetSqe( void )
+{
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&m_Ring);
+    if (!sqe)
+    {
+        // The submission queue is full, make room for a new request
+        io_uring_submit(&m_Ring);
+        sqe = io_uring_get_sqe(&m_Ring);
+    }
+    return sqe;
+}
+
+
+bool AsyncFileWriter::SubmitOpen( Job* job )
+{
+    // Creating the file is a round trip to the server on network file
+    // systems, it is not waited for on the encoding thread.
+    struct io_uring_sqe* sqe = m_RingOpen ? GetSqe() : NULL;
+    if (!sqe)
+        return Opened(job, OpenFile(job->fileName, job->data.size()), false);
+
+    io_uring_prep_openat(sqe, AT_FDCWD, job->fileName.c_str(), openflags, openmode);
+    io_uring_sqe_set_data(sqe, job);
+    io_uring_submit(&m_Ring);
+    ++m_InFlight;
+    return true;
+}
+
+
+bool AsyncFileWriter::Opened( Job* job, int fd, bool preallocate )
+{
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: Cannot open \"" << job->fileName << "\": " << std::strerror(errno) << std::endl;
+        delete job;
+        m_Error = true;
+        return false;
+    }
+    job->fd = fd;
+    job->stage = Writing;
+
+    // The preallocation (see OpenFile) is linked to the write, which runs
+    // whatever its result: not all the file systems support it.
+    if (preallocate && !job->data.empty())
+    {
+        if (io_uring_sq_space_left(&m_Ring) < 2)
+            io_uring_submit(&m_Ring);
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&m_Ring);
+        if (sqe)
+        {
+            io_uring_prep_fallocate(sqe, job->fd, 0, 0, job->data.size());
+            sqe->flags |= IOSQE_IO_HARDLINK;
+            io_uring_sqe_set_data(sqe, NULL);
+            ++m_InFlight;
+        }
+    }
+    return SubmitWrite(job);
+}
+
+
+bool AsyncFileWriter::SubmitWrite( Job* job )
+{
+    if (job->written == job->data.size())
+    {
+        // Nothing (left) to write
+        if (m_SyncFiles)
+            return SubmitSync(job);
+        m_PendingClose.push_back(job->fd);
+        delete job;
+        return true;
+    }
+
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+    {
+        std::cerr << "ERROR: Cannot queue write of \"" << job->fileName << "\"." << std::endl;
+        CloseFile(job->fd);
+        delete job;
+        m_Error = true;
+        return false;
+    }
+    io_uring_prep_write(sqe, job->fd,
+                        &job->data[0] + job->written,
+                        static_cast<unsigned int>(job->data.size() - job->written),
+                        job->written);
+    io_uring_sqe_set_data(sqe, job);
+    io_uring_submit(&m_Ring);
+    ++m_InFlight;
+    return true;
+}
+
+
+bool AsyncFileWriter::SubmitSync( Job* job )
+{
+    job->stage = Syncing;
+    struct io_uring_sqe* sqe = GetSqe();
+    if (!sqe)
+    {
+        const bool ret = SyncFileDescriptor(job->fd);
+        if (!ret)
+        {
+            std::cerr << "ERROR: Cannot sync \"" << job->fileName << "\"." << std::endl;
+            m_Error = true;
+        }
+        m_PendingClose.push_back(job->fd);
+        delete job;
+        return ret;
+    }
+    io_uring_prep_fsync(sqe, job->fd, 0);
+    io_uring_sqe_set_data(sqe, job);
+    io_uring_submit(&m_Ring);
+    ++m_InFlight;
+    return true;
+}
+
+
+void AsyncFileWriter::SubmitCloses( void )
+{
+    for (std::size_t i = 0; i < m_PendingClose.size(); ++i)
+    {
+        struct io_uring_sqe* sqe = GetSqe();
+        if (!sqe)
+        {
+            CloseFile(m_PendingClose[i]);
+            continue;
+        }
+        Job* job = new Job;
+        job->written = 0;
+        job->fd = m_PendingClose[i];
+        job->stage = Closing;
+        io_uring_prep_close(sqe, job->fd);
+        io_uring_sqe_set_data(sqe, job);
+        ++m_InFlight;
+    }
+    m_PendingClose.clear();
+    io_uring_submit(&m_Ring);
+}
+
+
+bool AsyncFileWriter::Reap( bool wait )
+{
+    struct io_uring_cqe* cqe;
+    int ret;
+    do
+    {
+        ret = wait ? io_uring_wait_cqe(&m_Ring, &cqe) : io_uring_peek_cqe(&m_Ring, &cqe);
+    } while (ret == -EINTR);
+    if (ret < 0)
+        return ret == -EAGAIN && !wait;
+
+    do
+    {
+        Job* job = static_cast<Job*>(io_uring_cqe_get_data(cqe));
+        const int res = cqe->res;
+        io_uring_cqe_seen(&m_Ring, cqe);
+        --m_InFlight;
+
+        if (!job)
+        {
+            // Preallocation, best effort
+        }
+        else if (job->stage == Opening)
+        {
+            // Kernels older than 5.6 cannot open through io_uring
+            if (res == -EINVAL || res == -EOPNOTSUPP)
+            {
+                m_RingOpen = false;
+                Opened(job, OpenFile(job->fileName, job->data.size()), false);
+            }
+            else
+            {
+                if (res < 0)
+                    errno = -res;
+                Opened(job, res, true);
+            }
+        }
+        else if (job->stage == Closing)
+        {
+            // Kernels older than 5.6 cannot close through io_uring
+            if (res == -EINVAL || res == -EOPNOTSUPP)
+            {
+                if (!CloseFile(job->fd))
+                    m_Error = true;
+            }
+            else if (res < 0)
+            {
+                m_Error = true;
+            }
+            delete job;
+        }
+        else if (job->stage == Syncing)
+        {
+            if (res < 0)
+            {
+                std::cerr << "ERROR: Cannot sync \"" << job->fileName << "\": " << std::strerror(-res) << std::endl;
+                m_Error = true;
+            }
+            m_PendingClose.push_back(job->fd);
+            delete job;
+        }
+        else if (res <= 0)
+        {
+            std::cerr << "ERROR: Cannot write \"" << job->fileName << "\": "
+                      << (res < 0 ? std::strerror(-res) : "no data written") << std::endl;
+            m_PendingClose.push_back(job->fd);
+            delete job;
+            m_Error = true;
+        }
+        else
+        {
+            // Short writes are resubmitted for the remaining data
+            job->written += static_cast<std::size_t>(res);
+            SubmitWrite(job);
+        }
+    } while (io_uring_peek_cqe(&m_Ring, &cqe) == 0);
+
+    if (m_PendingClose.size() >= closebatch)
+        SubmitCloses();
+    return true;
+}
+
+
+bool AsyncFileWriter::Close( void )
+{
+    if (!m_Open)
+        return !m_Error;
+
+    while (m_InFlight > 0 || !m_PendingClose.empty())
+    {
+        if (!m_PendingClose.empty())
+            SubmitCloses();
+        if (m_InFlight > 0 && !Reap(true))
+        {
+            m_Error = true;
+            break;
+        }
+    }
+
+    io_uring_queue_exit(&m_Ring);
+    m_Open = false;
+    return !m_Error;
+}
+//END io_uring backend
+
+#else // N2D_HAVE_LIBURING
+
+//BEGIN Thread pool backend
+bool AsyncFileWriter::Open( void )
+{
+    const unsigned int nbThreads = m_Depth < maxthreads ? m_Depth : maxthreads;
+    m_Done = false;
+    try
+    {
+        for (unsigned int i = 0; i < nbThreads; ++i)
+            m_Threads.push_back(std::thread(&AsyncFileWriter::Worker, this));
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: Cannot start writer threads: " << e.what() << std::endl;
+        if (m_Threads.empty())
+            return false;
+    }
+    m_Open = true;
+    return true;
+}
+
+
+bool AsyncFileWriter::Write( const std::string& fileName, const char* data, std::size_t size )
+{
+    Job* job = new Job;
+    job->fileName = fileName;
+    job->data.assign(data, data + size);
+    job->written = 0;
+    job->fd = -1;
+    job->stage = Writing;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_QueueNotFull.wait(lock, [this] { return m_Queue.size() < m_Depth || m_Error; });
+    if (m_Error)
+    {
+        delete job;
+        return false;
+    }
+    m_Queue.push_back(job);
+    lock.unlock();
+    m_QueueNotEmpty.notify_one();
+    return true;
+}
+
+
+void AsyncFileWriter::Failed( const Job* job, const char* what )
+{
+    const int error = errno;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::cerr << "ERROR: Cannot " << what << " \"" << job->fileName << "\": " << std::strerror(error) << std::endl;
+    m_Error = true;
+}
+
+
+void AsyncFileWriter::Worker( void )
+{
+    for (;;)
+    {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_QueueNotEmpty.wait(lock, [this] { return m_Done || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return;
+            job = m_Queue.front();
+            m_Queue.pop_front();
+        }
+        m_QueueNotFull.notify_one();
+
+        job->fd = OpenFile(job->fileName, job->data.size());
+        if (job->fd < 0)
+        {
+            Failed(job, "open");
+            delete job;
+            continue;
+        }
+
+        while (job->written < job->data.size())
+        {
+#ifndef _WIN32
+            const ssize_t res = write(job->fd, &job->data[0] + job->written, job->data.size() - job->written);
+#else
+            const int res = _write(job->fd, &job->data[0] + job->written, static_cast<unsigned int>(job->data.size() - job->written));
+#endif
+            if (res < 0 && errno == EINTR)
+                continue;
+            if (res <= 0)
+            {
+                Failed(job, "write");
+                break;
+            }
+            job->written += static_cast<std::size_t>(res);
+        }
+
+        if (m_SyncFiles && job->written == job->data.size() && !SyncFileDescriptor(job->fd))
+            Failed(job, "sync");
+
+        std::vector<int> batch;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_PendingClose.push_back(job->fd);
+            if (m_PendingClose.size() >= closebatch)
+                batch.swap(m_PendingClose);
+        }
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            if (!CloseFile(batch[i]))
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Error = true;
+            }
+        }
+        delete job;
+    }
+}
+
+
+bool AsyncFileWriter::Close( void )
+{
+    if (!m_Open)
+        return !m_Error;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Done = true;
+    }
+    m_QueueNotEmpty.notify_all();
+    for (std::size_t i = 0; i < m_Threads.size(); ++i)
+        m_Threads[i].join();
+    m_Threads.clear();
+
+    for (std::size_t i = 0; i < m_PendingClose.size(); ++i)
+        if (!CloseFile(m_PendingClose[i]))
+            m_Error = true;
+    m_PendingClose.clear();
+
+    m_Open = false;
+    return !m_Error;
+}
+//END Thread pool backend
+
+#endif // N2D_HAVE_LIBURING
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,140 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSASYNCFILEWRITER_H
+#define N2DTOOLSASYNCFILEWRITER_H
+
+#include "Nifti2DicomConfig.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+
+#ifdef N2D_HAVE_LIBURING
+ #include <liburing.h>
+#else
+ #include <thread>
+ #include <mutex>
+ #include <condition_variable>
+#endif
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::AsyncFileWriter
+/*!
+ * \brief Writes many small files keeping several writes in flight
+ *
+ * Every file is preallocated to its final size and written in a single
+ * request, the file descriptors are closed in batches. On Linux, if
+ * Nifti2Dicom was built with liburing, the files are opened, preallocated,
+ * written and closed through an io_uring (the kernels that cannot open or
+ * close files this way do it directly), otherwise they are written by a
+ * pool of threads. This keeps
+ * high latency storage (network file systems, object storage mounts)
+ * busy instead of waiting for each file in turn.
+ */
+class AsyncFileWriter
+{
+public:
+/*!
+ * \param depth Maximum number of writes in flight.
+ * \param syncFiles Flush every file to stable storage before closing it.
+ */
+    AsyncFileWriter( unsigned int depth, bool syncFiles );
+    ~AsyncFileWriter();
+
+    bool Open( void );
+
+/*!
+ * \brief Queue a file for writing.
+ *
+ * The data is copied, so the buffer can be reused as soon as this returns.
+ * Blocks while the maximum number of writes is in flight.
+ *
+ * \return false if an error occurred in this or in a previous write.
+ */
+    bool Write( const std::string& fileName, const char* data, std::size_t size );
+
+/*!
+ * \brief Wait for all the pending writes and close the files.
+ *
+ * \return true if all the files were written successfully.
+ */
+    bool Close( void );
+
+/*!
+ * \brief Name of the backend in use ("io_uring" or "threads").
+ */
+    static const char* GetBackendName( void );
+
+private:
+// Not implemented
+    AsyncFileWriter(const AsyncFileWriter&);
+    AsyncFileWriter& operator=(const AsyncFileWriter&);
+
+    enum Stage { Opening, Writing, Syncing, Closing };
+
+    struct Job
+    {
+        std::string fileName;
+        std::vector<char> data;
+        std::size_t written;
+        int fd;
+        Stage stage;
+    };
+
+    unsigned int m_Depth;
+    bool m_SyncFiles;
+    bool m_Error;
+    bool m_Open;
+    std::vector<int> m_PendingClose; //!< Written files waiting to be closed
+
+#ifdef N2D_HAVE_LIBURING
+    struct io_uring_sqe* GetSqe( void );
+    bool SubmitOpen( Job* job );
+    bool Opened( Job* job, int fd, bool preallocate );
+    bool SubmitWrite( Job* job );
+    bool SubmitSync( Job* job );
+    void SubmitCloses( void );
+    bool Reap( bool wait );
+
+    struct io_uring m_Ring;
+    unsigned int m_InFlight;
+    bool m_RingOpen; //!< Files are opened through the ring, until the kernel refuses
+#else
+    void Worker( void );
+    void Failed( const Job* job, const char* what );
+
+    std::vector<std::thread> m_Threads;
+    std::deque<Job*> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueNotFull;
+    std::condition_variable m_QueueNotEmpty;
+    bool m_Done;
+#endif
+};
+//END class n2d::tools::AsyncFileWriter
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSASYNCFILEWRITER_H
@@ -0,0 +1,131 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSCONTENTREGION_H
+#define N2DTOOLSCONTENTREGION_H
+
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+namespace n2d {
+namespace tools {
+
+/*!
+ * \brief Get the smallest region holding the pixels of an image that are
+ * not \c background, grown by \c margin pixels on each side.
+ *
+ * The buffered region of the image is scanned, its slices are split among a
+ * pool of threads. Each row is scanned from both ends, so only the rows
+ * holding content are walked up to their last pixel. The region is clamped
+ * to the buffered region and keeps its index, so pixels keep their position
+ * in the whole volume.
+ *
+ * \return false if all the pixels are \c background.
+ */
+template<class TImage>
+bool GetContentRegion( const TImage* image, typename TImage::PixelType background, unsigned int margin, typename TImage::RegionType& region )
+{
+    typedef typename TImage::PixelType PixelType;
+
+    const typename TImage::RegionType buffered = image->GetBufferedRegion();
+    const long long size[3] = { static_cast<long long>(buffered.GetSize()[0]),
+                                static_cast<long long>(buffered.GetSize()[1]),
+                                static_cast<long long>(buffered.GetSize()[2]) };
+    const PixelType* buffer = image->GetBufferPointer();
+
+    // Bounds of the content, lower > upper if there is none
+    struct Bounds
+    {
+        long long lower[3];
+        long long upper[3];
+    };
+
+    std::size_t threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > static_cast<std::size_t>(size[2]))
+        threads = size[2] > 0 ? static_cast<std::size_t>(size[2]) : 1;
+
+    std::vector<Bounds> partials(threads);
+    auto job = [&](Bounds& bounds, long long first, long long last)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            bounds.lower[k] = size[k];
+            bounds.upper[k] = -1;
+        }
+        for (long long z = first; z < last; z++)
+        {
+            for (long long y = 0; y < size[1]; y++)
+            {
+                const PixelType* row = buffer + (z * size[1] + y) * size[0];
+                long long x0 = 0;
+                while (x0 < size[0] && row[x0] == background)
+                    ++x0;
+                if (x0 == size[0])
+                    continue;
+                long long x1 = size[0] - 1;
+                while (row[x1] == background)
+                    --x1;
+                bounds.lower[0] = x0 < bounds.lower[0] ? x0 : bounds.lower[0];
+                bounds.upper[0] = x1 > bounds.upper[0] ? x1 : bounds.upper[0];
+                bounds.lower[1] = y < bounds.lower[1] ? y : bounds.lower[1];
+                bounds.upper[1] = y > bounds.upper[1] ? y : bounds.upper[1];
+                bounds.lower[2] = z < bounds.lower[2] ? z : bounds.lower[2];
+                bounds.upper[2] = z;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; t++)
+        pool.push_back(std::thread(job, std::ref(partials[t]), size[2] * t / threads, size[2] * (t + 1) / threads));
+    job(partials[0], 0, size[2] / threads);
+    for (std::size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+
+    Bounds bounds = partials[0];
+    for (std::size_t t = 1; t < threads; t++)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            bounds.lower[k] = partials[t].lower[k] < bounds.lower[k] ? partials[t].lower[k] : bounds.lower[k];
+            bounds.upper[k] = partials[t].upper[k] > bounds.upper[k] ? partials[t].upper[k] : bounds.upper[k];
+        }
+    }
+    if (bounds.lower[2] > bounds.upper[2])
+        return false;
+
+    region = buffered;
+    for (unsigned int k = 0; k < 3; k++)
+    {
+        const long long lower = bounds.lower[k] > margin ? bounds.lower[k] - margin : 0;
+        const long long upper = bounds.upper[k] + margin < size[k] ? bounds.upper[k] + margin : size[k] - 1;
+        region.SetIndex(k, buffered.GetIndex()[k] + lower);
+        region.SetSize(k, upper - lower + 1);
+    }
+    return true;
+}
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSCONTENTREGION_H
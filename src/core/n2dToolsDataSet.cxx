@@ -0,0 +1,103 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsDataSet.h"
+
+#include <gdcmWriter.h>
+#include <gdcmGlobal.h>
+#include <gdcmDicts.h>
+#include <gdcmItem.h>
+
+
+namespace n2d {
+namespace tools {
+
+void SetString( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const std::string& value )
+{
+    const gdcm::VR vr = gdcm::Global::GetInstance().GetDicts().GetDictEntry(tag).GetVR();
+    std::string padded = value;
+    if (padded.size() % 2)
+        padded += (vr == gdcm::VR::UI ? '\0' : ' ');
+    gdcm::DataElement element(tag);
+    element.SetVR(vr);
+    element.SetByteValue(padded.c_str(), static_cast<uint32_t>(padded.size()));
+    dataSet.Replace(element);
+}
+
+
+void SetStringIfMissing( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const std::string& value )
+{
+    if (!dataSet.FindDataElement(tag))
+        SetString(dataSet, tag, value);
+}
+
+
+bool SetDictionaryEntry( gdcm::DataSet& dataSet, const std::string& key, const std::string& value )
+{
+    gdcm::Tag tag;
+    if (!tag.ReadFromPipeSeparatedString(key.c_str()))
+        return false;
+    const gdcm::VR::VRType vr = gdcm::Global::GetInstance().GetDicts().GetDictEntry(tag).GetVR();
+    if (!(vr & gdcm::VR::VRASCII))
+        return false;
+    SetString(dataSet, tag, value);
+    return true;
+}
+
+
+void AddItem( gdcm::SequenceOfItems& sequence, const gdcm::DataSet& nested )
+{
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    item.SetNestedDataSet(nested);
+    sequence.AddItem(item);
+}
+
+
+void SetSequence( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const gdcm::SmartPointer<gdcm::SequenceOfItems>& sequence )
+{
+    gdcm::DataElement element(tag);
+    element.SetVR(gdcm::VR::SQ);
+    element.SetValue(*sequence);
+    element.SetVLToUndefined();
+    dataSet.Replace(element);
+}
+
+
+void SetItem( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const gdcm::DataSet& nested )
+{
+    gdcm::SmartPointer<gdcm::SequenceOfItems> sequence = new gdcm::SequenceOfItems;
+    sequence->SetLengthToUndefined();
+    AddItem(*sequence, nested);
+    SetSequence(dataSet, tag, sequence);
+}
+
+
+bool WriteDataSet( const gdcm::DataSet& dataSet, const std::string& fileName )
+{
+    gdcm::Writer writer;
+    writer.SetFileName(fileName.c_str());
+    writer.GetFile().SetDataSet(dataSet);
+    writer.GetFile().GetHeader().SetDataSetTransferSyntax(gdcm::TransferSyntax::ExplicitVRLittleEndian);
+    return writer.Write();
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,83 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSDATASET_H
+#define N2DTOOLSDATASET_H
+
+#include <gdcmDataSet.h>
+#include <gdcmSequenceOfItems.h>
+#include <gdcmTag.h>
+
+#include <string>
+
+namespace n2d {
+namespace tools {
+
+/*!
+ * \brief Set a tag with a string value.
+ *
+ * The VR is the one of the DICOM dictionary, the value is padded to an even
+ * length ('\0' for UI, ' ' otherwise).
+ */
+void SetString( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const std::string& value );
+
+/*!
+ * \brief Set a tag with a string value if the data set does not have it.
+ *
+ * Used for the type 2 attributes, written empty when they are missing.
+ */
+void SetStringIfMissing( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const std::string& value );
+
+/*!
+ * \brief Set a tag from an entry of an itk::MetaDataDictionary.
+ *
+ * \return false if \c key is not a "gggg|eeee" tag or if its VR is not
+ * a string VR: these entries are not copied.
+ */
+bool SetDictionaryEntry( gdcm::DataSet& dataSet, const std::string& key, const std::string& value );
+
+/*!
+ * \brief Append an item holding \c nested to a sequence.
+ */
+void AddItem( gdcm::SequenceOfItems& sequence, const gdcm::DataSet& nested );
+
+/*!
+ * \brief Set a sequence, with an undefined length.
+ */
+void SetSequence( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const gdcm::SmartPointer<gdcm::SequenceOfItems>& sequence );
+
+/*!
+ * \brief Set a sequence holding a single item.
+ */
+void SetItem( gdcm::DataSet& dataSet, const gdcm::Tag& tag, const gdcm::DataSet& nested );
+
+/*!
+ * \brief Write a data set to a file, in Explicit VR Little Endian.
+ *
+ * The file meta information is generated from the data set.
+ *
+ * \return true on success.
+ */
+bool WriteDataSet( const gdcm::DataSet& dataSet, const std::string& fileName );
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSDATASET_H
@@ -0,0 +1,74 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSHASH_H
+#define N2DTOOLSHASH_H
+
+#include <string>
+#include <cstddef>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::Hash
+/*!
+ * \brief Incremental 64 bit FNV-1a hash
+ *
+ * Not cryptographic, but cheap and good enough to detect changes in the
+ * data or to spread names over directories.
+ */
+class Hash
+{
+public:
+    Hash() : m_Value(14695981039346656037ULL) {}
+
+    inline void Update( const void* data, std::size_t size )
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_Value ^= bytes[i];
+            m_Value *= 1099511628211ULL;
+        }
+    }
+
+    inline void Update( const std::string& value )
+    {
+        Update(value.data(), value.size());
+        // Separator, so that ("ab", "c") and ("a", "bc") differ
+        Update("", 1);
+    }
+
+    inline unsigned long long GetValue( void ) const { return m_Value; }
+
+/*!
+ * \brief Get the value as 16 hex digits.
+ */
+    std::string GetHexDigest( void ) const;
+
+private:
+    unsigned long long m_Value;
+};
+//END class n2d::tools::Hash
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSHASH_H
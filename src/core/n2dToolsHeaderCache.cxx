@@ -0,0 +1,409 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsHeaderCache.h"
+#include "n2dToolsHash.h"
+
+#include <itksys/SystemTools.hxx>
+#include <itksys/Directory.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+#ifndef _WIN32
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+
+const char cachemagic[8] = { 'N', '2', 'D', 'H', 'C', 0, 0, 2 }; // Last byte is the format version
+const unsigned int byteorder = 0x01020304;                       // Entries are not portable between architectures
+const char cachesuffix[] = ".n2dhc";
+
+
+/*
+ * Read only view of a whole file, mapped in memory when possible
+ */
+class MappedFile
+{
+public:
+    MappedFile( const std::string& fileName ) : m_Data(NULL), m_Size(0), m_Mapped(false)
+    {
+#ifndef _WIN32
+        const int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* data = mmap(NULL, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_Data = static_cast<const char*>(data);
+                m_Size = static_cast<std::size_t>(info.st_size);
+                m_Mapped = true;
+            }
+        }
+        close(fd);
+#else
+        std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+        m_Buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!m_Buffer.empty())
+        {
+            m_Data = &m_Buffer[0];
+            m_Size = m_Buffer.size();
+        }
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (m_Mapped)
+            munmap(const_cast<char*>(m_Data), m_Size);
+#endif
+    }
+
+    inline const char* GetData( void ) const { return m_Data; }
+    inline std::size_t GetSize( void ) const { return m_Size; }
+
+private:
+    const char* m_Data;
+    std::size_t m_Size;
+    bool m_Mapped;
+#ifdef _WIN32
+    std::vector<char> m_Buffer;
+#endif
+};
+
+
+/*
+ * Bounds checked reader of an entry
+ */
+class EntryReader
+{
+public:
+    EntryReader( const char* data, std::size_t size ) : m_Pos(data), m_End(data + size) {}
+
+    bool Read( void* value, std::size_t size )
+    {
+        if (static_cast<std::size_t>(m_End - m_Pos) < size)
+            return false;
+        std::memcpy(value, m_Pos, size);
+        m_Pos += size;
+        return true;
+    }
+
+    bool Read( std::string& value )
+    {
+        unsigned int size;
+        if (!Read(&size, sizeof(size)) || static_cast<std::size_t>(m_End - m_Pos) < size)
+            return false;
+        value.assign(m_Pos, size);
+        m_Pos += size;
+        return true;
+    }
+
+    bool Read( DictionaryType& dict )
+    {
+        unsigned int count;
+        if (!Read(&count, sizeof(count)))
+            return false;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            std::string key, value;
+            if (!Read(key) || !Read(value))
+                return false;
+            itk::EncapsulateMetaData<std::string>(dict, key, value);
+        }
+        return true;
+    }
+
+    inline bool AtEnd( void ) const { return m_Pos == m_End; }
+
+private:
+    const char* m_Pos;
+    const char* m_End;
+};
+
+
+/*
+ * Content hash of a whole file
+ */
+bool HashFile( const std::string& fileName, unsigned long long& value )
+{
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+        return false;
+    Hash hash;
+    std::vector<char> buffer(1 << 20);
+    while (file)
+    {
+        file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+        hash.Update(&buffer[0], static_cast<std::size_t>(file.gcount()));
+    }
+    if (!file.eof())
+        return false;
+    value = hash.GetValue();
+    return true;
+}
+
+
+void Write( std::string& entry, const void* value, std::size_t size )
+{
+    entry.append(static_cast<const char*>(value), size);
+}
+
+
+void Write( std::string& entry, const std::string& value )
+{
+    const unsigned int size = static_cast<unsigned int>(value.size());
+    Write(entry, &size, sizeof(size));
+    entry.append(value);
+}
+
+
+void Write( std::string& entry, const DictionaryType& dict )
+{
+    std::vector<std::pair<std::string, std::string> > values;
+    for (DictionaryType::ConstIterator it = dict.Begin(); it != dict.End(); ++it)
+    {
+        const MetaDataStringType* value = dynamic_cast<const MetaDataStringType*>(it->second.GetPointer());
+        if (value)
+            values.push_back(std::make_pair(it->first, value->GetMetaDataObjectValue()));
+    }
+    const unsigned int count = static_cast<unsigned int>(values.size());
+    Write(entry, &count, sizeof(count));
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        Write(entry, values[i].first);
+        Write(entry, values[i].second);
+    }
+}
+
+} // namespace
+
+
+
+bool HeaderCache::Open( const std::string& reference )
+{
+    m_Reference = itksys::SystemTools::CollapseFullPath(reference);
+    m_Files.clear();
+
+    // Same files read by HeaderImporter
+    std::vector<std::string> fileNames;
+    if (itksys::SystemTools::FileIsDirectory(m_Reference))
+    {
+        itksys::Directory dir;
+        if (!dir.Load(m_Reference))
+            return false;
+        for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+        {
+            const std::string name = dir.GetFile(i);
+            if (!name.empty() && name[0] != '.' && !itksys::SystemTools::FileIsDirectory(m_Reference + "/" + name))
+                fileNames.push_back(m_Reference + "/" + name);
+        }
+        std::sort(fileNames.begin(), fileNames.end());
+    }
+    else
+        fileNames.push_back(m_Reference);
+
+    for (std::size_t i = 0; i < fileNames.size(); ++i)
+    {
+        if (!itksys::SystemTools::FileExists(fileNames[i]))
+            return false;
+        FileIdentity identity;
+        identity.name = fileNames[i];
+        identity.size = itksys::SystemTools::FileLength(fileNames[i]);
+        identity.mtime = itksys::SystemTools::ModifiedTime(fileNames[i]);
+        identity.hash = 0;
+        identity.hashed = false;
+        m_Files.push_back(identity);
+    }
+    return true;
+}
+
+
+
+std::string HeaderCache::GetEntryFileName( void ) const
+{
+    Hash pathHash;
+    pathHash.Update(m_Reference);
+    return m_Directory + "/" + pathHash.GetHexDigest() + cachesuffix;
+}
+
+
+
+bool HeaderCache::Load( DictionaryType& dict, SliceHeaderIndex& sliceHeaders )
+{
+    if (m_Reference.empty())
+        return false;
+
+    const MappedFile entry(GetEntryFileName());
+    EntryReader reader(entry.GetData(), entry.GetSize());
+
+    // Identity of the reference
+    char magic[sizeof(cachemagic)];
+    unsigned int order;
+    std::string reference;
+    unsigned int nbFiles;
+    if (!reader.Read(magic, sizeof(magic)) || std::memcmp(magic, cachemagic, sizeof(magic)) != 0 ||
+        !reader.Read(&order, sizeof(order)) || order != byteorder ||
+        !reader.Read(reference) || reference != m_Reference ||
+        !reader.Read(&nbFiles, sizeof(nbFiles)) || nbFiles != m_Files.size())
+        return false;
+    bool touched = false;
+    for (unsigned int i = 0; i < nbFiles; ++i)
+    {
+        FileIdentity identity;
+        if (!reader.Read(identity.name) || identity.name != m_Files[i].name ||
+            !reader.Read(&identity.size, sizeof(identity.size)) || identity.size != m_Files[i].size ||
+            !reader.Read(&identity.mtime, sizeof(identity.mtime)) ||
+            !reader.Read(&identity.hash, sizeof(identity.hash)))
+            return false;
+
+        // Only a file with a new modification time is read, to tell
+        // whether its content changed.
+        if (identity.mtime != m_Files[i].mtime)
+        {
+            if (!m_Files[i].hashed && HashFile(m_Files[i].name, m_Files[i].hash))
+                m_Files[i].hashed = true;
+            if (!m_Files[i].hashed || m_Files[i].hash != identity.hash)
+                return false;
+            touched = true;
+        }
+        else
+        {
+            m_Files[i].hash = identity.hash;
+            m_Files[i].hashed = true;
+        }
+    }
+
+    // Imported header and per-slice attributes
+    DictionaryType cachedDict;
+    SliceHeaderIndex cachedSliceHeaders;
+    unsigned int nbSlices;
+    double normal[3];
+    if (!reader.Read(cachedDict) || !reader.Read(&nbSlices, sizeof(nbSlices)) || !reader.Read(normal, sizeof(normal)))
+        return false;
+    cachedSliceHeaders.Reset(normal);
+    for (unsigned int i = 0; i < nbSlices; ++i)
+    {
+        double position;
+        DictionaryType sliceDict;
+        if (!reader.Read(&position, sizeof(position)) || !reader.Read(sliceDict))
+            return false;
+        cachedSliceHeaders.Add(position, sliceDict);
+    }
+    if (!reader.AtEnd())
+        return false;
+
+    cachedSliceHeaders.Update();
+    dict = cachedDict;
+    sliceHeaders = cachedSliceHeaders;
+
+    // Next time the files are not read again
+    if (touched)
+        Store(dict, sliceHeaders);
+    return true;
+}
+
+
+
+bool HeaderCache::Store( const DictionaryType& dict, const SliceHeaderIndex& sliceHeaders )
+{
+    if (m_Reference.empty())
+        return false;
+
+    std::string entry;
+    Write(entry, cachemagic, sizeof(cachemagic));
+    Write(entry, &byteorder, sizeof(byteorder));
+    Write(entry, m_Reference);
+    const unsigned int nbFiles = static_cast<unsigned int>(m_Files.size());
+    Write(entry, &nbFiles, sizeof(nbFiles));
+    for (unsigned int i = 0; i < nbFiles; ++i)
+    {
+        if (!m_Files[i].hashed && !HashFile(m_Files[i].name, m_Files[i].hash))
+            return false;
+        m_Files[i].hashed = true;
+        Write(entry, m_Files[i].name);
+        Write(entry, &m_Files[i].size, sizeof(m_Files[i].size));
+        Write(entry, &m_Files[i].mtime, sizeof(m_Files[i].mtime));
+        Write(entry, &m_Files[i].hash, sizeof(m_Files[i].hash));
+    }
+
+    Write(entry, dict);
+    const unsigned int nbSlices = sliceHeaders.GetNumberOfSlices();
+    Write(entry, &nbSlices, sizeof(nbSlices));
+    Write(entry, sliceHeaders.GetNormal(), 3 * sizeof(double));
+    for (unsigned int i = 0; i < nbSlices; ++i)
+    {
+        const double position = sliceHeaders.GetSlicePosition(i);
+        Write(entry, &position, sizeof(position));
+        Write(entry, sliceHeaders.GetSliceDictionary(i));
+    }
+
+    // Each process writes its own temporary file, readers only ever see
+    // complete entries.
+    itksys::SystemTools::MakeDirectory(m_Directory.c_str());
+    const std::string fileName = GetEntryFileName();
+    std::random_device random;
+    std::ostringstream tmpFileName;
+    tmpFileName << fileName << "." << std::hex << random() << random() << ".tmp";
+    {
+        std::ofstream file(tmpFileName.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+        file.flush();
+        if (!file)
+        {
+            file.close();
+            std::remove(tmpFileName.str().c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    std::remove(fileName.c_str());
+#endif
+    if (std::rename(tmpFileName.str().c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(tmpFileName.str().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace tools
+} // namespace n2d
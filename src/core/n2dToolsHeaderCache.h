@@ -0,0 +1,105 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSHEADERCACHE_H
+#define N2DTOOLSHEADERCACHE_H
+
+#include "n2dDefsMetadata.h"
+#include "n2dToolsSliceHeaderIndex.h"
+
+#include <string>
+#include <vector>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::HeaderCache
+/*!
+ * \brief On-disk cache of imported DICOM headers
+ *
+ * The header imported from a reference DICOM file (or the headers of a
+ * reference series directory, see n2d::HeaderImporter) is stored in a
+ * compact binary file in the cache directory, named after the path of the
+ * reference. The entry records the size, modification time and content
+ * hash of every reference file, and is used only if they all match. The
+ * content of a reference file is only read to compute its hash when the
+ * entry is stored, or when its size matches but not its modification time
+ * (e.g. the reference was copied), so that a hit reads no reference file.
+ *
+ * Entries are written to a temporary file and renamed, so processes
+ * sharing the cache never see a partial entry. Entries are read with a
+ * single memory mapping and validated while parsing, an invalid entry is
+ * ignored and written again.
+ */
+class HeaderCache
+{
+public:
+    HeaderCache( const std::string& directory ) : m_Directory(directory) {}
+
+/*!
+ * \brief Get the size and modification time of the files of a reference
+ * file or directory.
+ *
+ * \return false if the reference cannot be read.
+ */
+    bool Open( const std::string& reference );
+
+/*!
+ * \brief Load the entry of the reference, if it is valid.
+ *
+ * The files whose modification time changed are hashed, if their content
+ * did not change the entry is stored again with the new times.
+ *
+ * \return false if there is no valid entry, \c dict and \c sliceHeaders
+ *         are not modified in that case.
+ */
+    bool Load( DictionaryType& dict, SliceHeaderIndex& sliceHeaders );
+
+/*!
+ * \brief Store the entry of the reference.
+ *
+ * Reads the reference files that were not hashed yet.
+ *
+ * \return false if the entry cannot be written.
+ */
+    bool Store( const DictionaryType& dict, const SliceHeaderIndex& sliceHeaders );
+
+private:
+    struct FileIdentity
+    {
+        std::string name;
+        unsigned long long size;
+        long long mtime;
+        unsigned long long hash; //!< Content hash, valid if \c hashed
+        bool hashed;
+    };
+
+    std::string GetEntryFileName( void ) const;
+
+    std::string m_Directory;
+    std::string m_Reference; //!< Full path of the reference
+    std::vector<FileIdentity> m_Files;
+};
+//END class n2d::tools::HeaderCache
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSHEADERCACHE_H
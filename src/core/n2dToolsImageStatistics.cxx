@@ -0,0 +1,159 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "n2dToolsImageStatistics.h"
+
+#include <thread>
+#include <cstdlib>
+
+
+namespace n2d {
+namespace tools {
+
+//BEGIN Default values
+const std::size_t minimumthreadvalues = 1 << 16; //!< Smallest part of the image given to a thread
+//END Default values
+
+
+const std::size_t ImageStatistics::histogrambins;
+
+
+
+ImageStatistics::ImageStatistics() :
+        m_Count(0),
+        m_Minimum(0.0),
+        m_Maximum(0.0),
+        m_Mean(0.0),
+        m_Integral(true),
+        m_Exact(false),
+        m_HistogramMinimum(0.0),
+        m_BinWidth(1.0)
+{
+}
+
+
+
+void ImageStatistics::Run( std::size_t count, std::vector<Partial>& partials,
+                           const std::function<void(Partial&, std::size_t, std::size_t)>& job )
+{
+    std::size_t threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > count / minimumthreadvalues + 1)
+        threads = count / minimumthreadvalues + 1;
+
+    partials.resize(threads);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; t++)
+        pool.push_back(std::thread(job, std::ref(partials[t]), count * t / threads, count * (t + 1) / threads));
+    job(partials[0], 0, count / threads);
+    for (std::size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+}
+
+
+
+void ImageStatistics::MergeRange( const std::vector<Partial>& partials )
+{
+    m_Minimum = std::numeric_limits<double>::max();
+    m_Maximum = -std::numeric_limits<double>::max();
+    m_Integral = true;
+    double sum = 0.0;
+    for (std::size_t t = 0; t < partials.size(); t++)
+    {
+        m_Minimum = partials[t].minimum < m_Minimum ? partials[t].minimum : m_Minimum;
+        m_Maximum = partials[t].maximum > m_Maximum ? partials[t].maximum : m_Maximum;
+        m_Integral = m_Integral && partials[t].integral;
+        sum += partials[t].sum;
+    }
+    if (m_Count == 0 || m_Minimum > m_Maximum)
+    {
+        // No values, or only NaN
+        m_Minimum = m_Maximum = 0.0;
+        m_Mean = 0.0;
+        return;
+    }
+    m_Mean = sum / m_Count;
+}
+
+
+
+void ImageStatistics::MergeHistogram( const std::vector<Partial>& partials )
+{
+    m_Histogram.clear();
+    if (partials.empty())
+        return;
+    m_Histogram.assign(partials[0].histogram.size(), 0);
+    for (std::size_t t = 0; t < partials.size(); t++)
+        for (std::size_t i = 0; i < partials[t].histogram.size() && i < m_Histogram.size(); i++)
+            m_Histogram[i] += partials[t].histogram[i];
+}
+
+
+
+double ImageStatistics::GetPercentile( double percent ) const
+{
+    unsigned long long total = 0;
+    for (std::size_t i = 0; i < m_Histogram.size(); i++)
+        total += m_Histogram[i];
+    if (total == 0)
+        return m_Minimum;
+
+    const double target = percent / 100.0 * total;
+    unsigned long long cumulative = 0;
+    for (std::size_t i = 0; i < m_Histogram.size(); i++)
+    {
+        const unsigned long long count = m_Histogram[i];
+        if (count == 0)
+            continue;
+        if (cumulative + count >= target)
+        {
+            if (m_Exact)
+                return m_HistogramMinimum + i;
+            // Values are assumed to be evenly spread within the bin
+            const double fraction = target > cumulative ? (target - cumulative) / count : 0.0;
+            const double value = m_HistogramMinimum + (i + fraction) * m_BinWidth;
+            return value < m_Minimum ? m_Minimum : (value > m_Maximum ? m_Maximum : value);
+        }
+        cumulative += count;
+    }
+    return m_Maximum;
+}
+
+
+
+bool ImageStatistics::ParsePercentiles( const std::string& value, double& low, double& high )
+{
+    const std::string::size_type comma = value.find(',');
+    if (comma == std::string::npos)
+        return false;
+
+    const std::string lowStr = value.substr(0, comma);
+    const std::string highStr = value.substr(comma + 1);
+    char* end;
+    low = std::strtod(lowStr.c_str(), &end);
+    if (lowStr.empty() || *end != '\0')
+        return false;
+    high = std::strtod(highStr.c_str(), &end);
+    if (highStr.empty() || *end != '\0')
+        return false;
+    return low >= 0.0 && low < high && high <= 100.0;
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,196 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef N2DTOOLSIMAGESTATISTICS_H
+#define N2DTOOLSIMAGESTATISTICS_H
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <functional>
+#include <cstddef>
+#include <cmath>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::ImageStatistics
+/*!
+ * \brief Statistics of the values of an image
+ *
+ * Minimum, maximum, mean, histogram and percentiles are computed by a pool
+ * of threads, each one walking a part of the buffer. For 8 and 16 bit
+ * integers the histogram has one bin per value and is filled in the same
+ * pass as the range, so percentiles are exact. For other types the range is
+ * needed to place the bins: a second pass fills a histogram of
+ * \c histogrambins bins between the minimum and the maximum, and
+ * percentiles are interpolated within a bin.
+ *
+ * The statistics are computed once and shared by all their users (output
+ * pixel type, rescaling, window).
+ */
+class ImageStatistics
+{
+public:
+    ImageStatistics();
+    ~ImageStatistics() {}
+
+/*!
+ * \brief Compute the statistics of \c count values.
+ */
+    template<class TPixel> void Compute( const TPixel* buffer, std::size_t count );
+
+    inline bool IsValid( void ) const { return m_Count > 0; }
+    inline std::size_t GetCount( void ) const { return m_Count; }
+    inline double GetMinimum( void ) const { return m_Minimum; }
+    inline double GetMaximum( void ) const { return m_Maximum; }
+    inline double GetMean( void ) const { return m_Mean; }
+
+/*!
+ * \brief Whether all the values are integers.
+ */
+    inline bool IsIntegral( void ) const { return m_Integral; }
+
+/*!
+ * \brief Histogram, bin \c i holds the values in
+ * [GetHistogramMinimum() + i * GetBinWidth(), GetHistogramMinimum() + (i + 1) * GetBinWidth()).
+ */
+    inline const std::vector<unsigned long long>& GetHistogram( void ) const { return m_Histogram; }
+    inline double GetHistogramMinimum( void ) const { return m_HistogramMinimum; }
+    inline double GetBinWidth( void ) const { return m_BinWidth; }
+
+/*!
+ * \brief Get the value below which \c percent percent of the values are.
+ *
+ * \param percent Percentile, between 0 and 100.
+ */
+    double GetPercentile( double percent ) const;
+
+/*!
+ * \brief Parse a pair of percentiles written as "low,high".
+ *
+ * \return false unless 0 <= low < high <= 100.
+ */
+    static bool ParsePercentiles( const std::string& value, double& low, double& high );
+
+    static const std::size_t histogrambins = 4096; //!< Number of bins of the histogram of wide types
+
+private:
+    // Not implemented
+    ImageStatistics( const ImageStatistics& );
+    ImageStatistics& operator=( const ImageStatistics& );
+
+    struct Partial
+    {
+        double minimum;
+        double maximum;
+        double sum;
+        bool integral;
+        std::vector<unsigned long long> histogram;
+    };
+
+    // Calls job(part, begin, end) on a pool of threads, the values are split
+    // in contiguous parts, one per thread.
+    static void Run( std::size_t count, std::vector<Partial>& partials,
+                     const std::function<void(Partial&, std::size_t, std::size_t)>& job );
+    void MergeRange( const std::vector<Partial>& partials );
+    void MergeHistogram( const std::vector<Partial>& partials );
+
+    std::size_t m_Count;
+    double m_Minimum;
+    double m_Maximum;
+    double m_Mean;
+    bool m_Integral;
+    bool m_Exact; //!< One bin per value
+    std::vector<unsigned long long> m_Histogram;
+    double m_HistogramMinimum;
+    double m_BinWidth;
+};
+//END class n2d::tools::ImageStatistics
+
+
+
+template<class TPixel> void ImageStatistics::Compute( const TPixel* buffer, std::size_t count )
+{
+    typedef std::numeric_limits<TPixel> Limits;
+    m_Count = count;
+    m_Exact = Limits::is_integer && sizeof(TPixel) <= 2;
+    m_HistogramMinimum = m_Exact ? static_cast<double>(Limits::min()) : 0.0;
+    m_BinWidth = 1.0;
+    const std::size_t exactBins = m_Exact ? (static_cast<std::size_t>(1) << (8 * sizeof(TPixel))) : 0;
+    const bool exact = m_Exact;
+    const TPixel lowest = Limits::min();
+
+    std::vector<Partial> partials;
+
+    // Range, sum and, for narrow integers, the histogram
+    Run(count, partials, [&](Partial& partial, std::size_t begin, std::size_t end)
+    {
+        partial.histogram.assign(exactBins, 0);
+        double minimum = std::numeric_limits<double>::max();
+        double maximum = -std::numeric_limits<double>::max();
+        double sum = 0.0;
+        bool integral = true;
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const double value = static_cast<double>(buffer[i]);
+            if (!Limits::is_integer && value != value)
+                continue; // NaN
+            minimum = value < minimum ? value : minimum;
+            maximum = value > maximum ? value : maximum;
+            sum += value;
+            if (exact)
+                ++partial.histogram[static_cast<std::size_t>(buffer[i] - lowest)];
+            else if (!Limits::is_integer && integral && value != std::floor(value))
+                integral = false;
+        }
+        partial.minimum = minimum;
+        partial.maximum = maximum;
+        partial.sum = sum;
+        partial.integral = integral;
+    });
+    MergeRange(partials);
+    if (m_Exact || m_Count == 0)
+    {
+        MergeHistogram(partials);
+        return;
+    }
+
+    // Histogram between the minimum and the maximum
+    const double minimum = m_Minimum;
+    const double scale = m_Maximum > m_Minimum ? histogrambins / (m_Maximum - m_Minimum) : 0.0;
+    m_HistogramMinimum = m_Minimum;
+    m_BinWidth = m_Maximum > m_Minimum ? (m_Maximum - m_Minimum) / histogrambins : 1.0;
+    Run(count, partials, [&](Partial& partial, std::size_t begin, std::size_t end)
+    {
+        partial.histogram.assign(histogrambins, 0);
+        for (std::size_t i = begin; i < end; i++)
+        {
+            if (buffer[i] != buffer[i])
+                continue; // NaN
+            std::size_t bin = static_cast<std::size_t>((static_cast<double>(buffer[i]) - minimum) * scale);
+            ++partial.histogram[bin < histogrambins ? bin : histogrambins - 1];
+        }
+    });
+    MergeHistogram(partials);
+}
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSIMAGESTATISTICS_H
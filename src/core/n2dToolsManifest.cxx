@@ -0,0 +1,203 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsManifest.h"
+#include "n2dToolsSync.h"
+
+#include <fstream>
+#include <cstdio>
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+// Lines are "tag<TAB>key<TAB>value" and "slice<TAB>hash<TAB>uid<TAB>name",
+// the name is the last field because it can contain anything but tabs.
+const std::string manifestheader ( "# nifti2dicom manifest 1" );
+} // namespace
+
+
+
+bool Manifest::Read( const std::string& fileName )
+{
+    m_Tags.clear();
+    m_Slices.clear();
+
+    std::ifstream file(fileName.c_str());
+    if (!file)
+        return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != manifestheader)
+        return false;
+
+    while (std::getline(file, line))
+    {
+        // Not terminated, the writer was interrupted (see Journal)
+        if (file.eof())
+            break;
+
+        // Lines broken by an interrupted writer are skipped
+        const std::string::size_type first = line.find('\t');
+        const std::string::size_type second = first == std::string::npos ? first : line.find('\t', first + 1);
+        if (second == std::string::npos)
+            continue;
+
+        const std::string type = line.substr(0, first);
+        if (type == "tag")
+        {
+            m_Tags[line.substr(first + 1, second - first - 1)] = line.substr(second + 1);
+        }
+        else if (type == "slice")
+        {
+            const std::string::size_type third = line.find('\t', second + 1);
+            if (third == std::string::npos)
+                continue;
+            Slice slice;
+            slice.hash = line.substr(first + 1, second - first - 1);
+            slice.sopInstanceUID = line.substr(second + 1, third - second - 1);
+            m_Slices[line.substr(third + 1)] = slice;
+        }
+    }
+    return true;
+}
+
+
+
+bool Manifest::Write( const std::string& fileName ) const
+{
+    const std::string tmpFileName = fileName + ".tmp";
+    {
+        std::ofstream file(tmpFileName.c_str(), std::ios::out | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file << manifestheader << '\n';
+        for (TagMapType::const_iterator it = m_Tags.begin(); it != m_Tags.end(); ++it)
+            file << "tag\t" << it->first << '\t' << it->second << '\n';
+        for (SliceMapType::const_iterator it = m_Slices.begin(); it != m_Slices.end(); ++it)
+            file << "slice\t" << it->second.hash << '\t' << it->second.sopInstanceUID << '\t' << it->first << '\n';
+
+        file.flush();
+        if (!file)
+        {
+            file.close();
+            std::remove(tmpFileName.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    std::remove(fileName.c_str());
+#endif
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(tmpFileName.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+
+const Manifest::Slice* Manifest::FindSlice( const std::string& name ) const
+{
+    SliceMapType::const_iterator it = m_Slices.find(name);
+    return it == m_Slices.end() ? NULL : &it->second;
+}
+
+
+
+Journal::Journal() :
+        m_File(NULL)
+{
+}
+
+
+
+Journal::~Journal()
+{
+    Close();
+}
+
+
+
+bool Journal::Open( const std::string& fileName, bool append )
+{
+    Close();
+    m_File = std::fopen(fileName.c_str(), append ? "a+" : "w");
+    if (!m_File)
+        return false;
+    if (append)
+    {
+        // Terminate the line left incomplete by an interrupted writer
+        if (std::fseek(m_File, -1, SEEK_END) == 0 && std::fgetc(m_File) != '\n')
+            return std::fputc('\n', m_File) != EOF && Flush();
+        return true;
+    }
+
+    // The entry of the new journal in the output directory is flushed too
+    const std::string::size_type slash = fileName.rfind('/');
+    return std::fprintf(m_File, "%s\n", manifestheader.c_str()) > 0 && Flush() &&
+           SyncDirectory(slash == std::string::npos ? "." : (slash == 0 ? "/" : fileName.substr(0, slash)));
+}
+
+
+
+bool Journal::AddTag( const std::string& key, const std::string& value )
+{
+    return m_File &&
+           std::fprintf(m_File, "tag\t%s\t%s\n", key.c_str(), value.c_str()) > 0 &&
+           Flush();
+}
+
+
+
+bool Journal::AddSlice( const std::string& name, const Manifest::Slice& slice )
+{
+    return m_File &&
+           std::fprintf(m_File, "slice\t%s\t%s\t%s\n", slice.hash.c_str(), slice.sopInstanceUID.c_str(), name.c_str()) > 0 &&
+           Flush();
+}
+
+
+
+bool Journal::Flush( void )
+{
+    // fflush() is enough after a crash of the process, fsync() is needed
+    // after a power loss: the slices listed are already on stable storage.
+    return std::fflush(m_File) == 0 && SyncFileDescriptor(fileno(m_File));
+}
+
+
+
+bool Journal::Close( void )
+{
+    if (!m_File)
+        return true;
+    const bool ret = std::fclose(m_File) == 0;
+    m_File = NULL;
+    return ret;
+}
+
+} // namespace tools
+} // namespace n2d
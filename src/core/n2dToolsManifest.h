@@ -0,0 +1,141 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSMANIFEST_H
+#define N2DTOOLSMANIFEST_H
+
+#include <string>
+#include <map>
+#include <cstdio>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::Manifest
+/*!
+ * \brief Record of a conversion, used to convert again only what changed
+ *
+ * The manifest is a text file written next to the output. It contains the
+ * values of the tags that are generated during the conversion (UIDs, dates
+ * and times), so that a new conversion can reuse them, and for every slice
+ * a hash of its content (pixels and tags) and its SOP Instance UID.
+ */
+class Manifest
+{
+public:
+    struct Slice
+    {
+        std::string hash;
+        std::string sopInstanceUID;
+    };
+
+    typedef std::map<std::string, std::string> TagMapType;
+    typedef std::map<std::string, Slice> SliceMapType;
+
+    Manifest() {}
+
+/*!
+ * \brief Read a manifest.
+ *
+ * \return false if the file does not exist or is not a valid manifest.
+ */
+    bool Read( const std::string& fileName );
+
+/*!
+ * \brief Write the manifest.
+ *
+ * The file is replaced atomically, so that an interrupted conversion
+ * leaves the previous manifest.
+ *
+ * \return true on success.
+ */
+    bool Write( const std::string& fileName ) const;
+
+    inline const TagMapType& GetTags( void ) const { return m_Tags; }
+    inline void SetTag( const std::string& key, const std::string& value ) { m_Tags[key] = value; }
+
+/*!
+ * \brief Find a slice by name.
+ *
+ * \return NULL if the slice is not in the manifest.
+ */
+    const Slice* FindSlice( const std::string& name ) const;
+    void SetSlice( const std::string& name, const Slice& slice ) { m_Slices[name] = slice; }
+
+/*!
+ * \brief Default name of the manifest in the output directory.
+ */
+    static const char* GetDefaultFileName( void ) { return "nifti2dicom.manifest"; }
+
+private:
+    TagMapType m_Tags;
+    SliceMapType m_Slices;
+};
+//END class n2d::tools::Manifest
+
+
+
+//BEGIN class n2d::tools::Journal
+/*!
+ * \brief Append-only manifest, written while a conversion is running
+ *
+ * Every entry is flushed to stable storage as soon as it is added, so
+ * that after a crash or a power loss the journal lists everything that
+ * was completed. It can be read back
+ * with Manifest::Read(), an incomplete last line is ignored.
+ */
+class Journal
+{
+public:
+    Journal();
+    ~Journal();
+
+/*!
+ * \brief Open the journal.
+ *
+ * \param append Add entries to an existing journal instead of starting a new one.
+ */
+    bool Open( const std::string& fileName, bool append );
+
+    bool AddTag( const std::string& key, const std::string& value );
+    bool AddSlice( const std::string& name, const Manifest::Slice& slice );
+
+    bool Close( void );
+
+/*!
+ * \brief Default name of the journal in the output directory.
+ */
+    static const char* GetDefaultFileName( void ) { return "nifti2dicom.journal"; }
+
+private:
+// Not implemented
+    Journal(const Journal&);
+    Journal& operator=(const Journal&);
+
+    bool Flush( void );
+
+    std::FILE* m_File;
+};
+//END class n2d::tools::Journal
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSMANIFEST_H
@@ -0,0 +1,108 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsMemoryFile.h"
+#include "Nifti2DicomConfig.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+ #include <unistd.h>
+ #include <sys/mman.h>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+MemoryFile::MemoryFile() :
+        m_Fd(-1),
+        m_Unlink(false)
+{
+#if defined(N2D_HAVE_MEMFD_CREATE)
+    m_Fd = memfd_create("nifti2dicom", MFD_CLOEXEC);
+    if (m_Fd >= 0)
+    {
+        std::ostringstream name;
+        name << "/proc/self/fd/" << m_Fd;
+        m_FileName = name.str();
+        return;
+    }
+#endif
+
+#ifndef _WIN32
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string pattern(tmpdir && *tmpdir ? tmpdir : "/tmp");
+    pattern += "/nifti2dicom-XXXXXX";
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    m_Fd = mkstemp(&name[0]);
+    if (m_Fd >= 0)
+    {
+        m_FileName = &name[0];
+        m_Unlink = true;
+    }
+#else
+    char name[L_tmpnam];
+    if (std::tmpnam(name))
+    {
+        m_FileName = name;
+        m_Unlink = true;
+    }
+#endif
+}
+
+
+
+MemoryFile::~MemoryFile()
+{
+    if (m_Unlink)
+        std::remove(m_FileName.c_str());
+#ifndef _WIN32
+    if (m_Fd >= 0)
+        close(m_Fd);
+#endif
+}
+
+
+
+bool MemoryFile::Read( std::vector<char>& buffer ) const
+{
+    std::ifstream file(m_FileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+        return false;
+
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    if (size < 0)
+        return false;
+    file.seekg(0, std::ios::beg);
+
+    buffer.resize(static_cast<std::size_t>(size));
+    if (size > 0)
+        file.read(&buffer[0], size);
+    return !file.fail();
+}
+
+} // namespace tools
+} // namespace n2d
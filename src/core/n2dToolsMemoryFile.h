@@ -0,0 +1,73 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSMEMORYFILE_H
+#define N2DTOOLSMEMORYFILE_H
+
+#include <string>
+#include <vector>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::MemoryFile
+/*!
+ * \brief A file that lives in memory but can be opened by name
+ *
+ * itkGDCMImageIO can only write to a file name, this class gives it a name
+ * that is backed by an anonymous memory file (memfd_create), so that encoded
+ * slices can be streamed somewhere else without touching the output file
+ * system. Where memfd_create is not available a temporary file is used.
+ */
+class MemoryFile
+{
+public:
+    MemoryFile();
+    ~MemoryFile();
+
+    inline bool IsValid( void ) const { return !m_FileName.empty(); }
+
+/*!
+ * \brief Get the name that can be used to write the file.
+ */
+    inline const std::string& GetFileName( void ) const { return m_FileName; }
+
+/*!
+ * \brief Read the current content of the file.
+ *
+ * \return true on success.
+ */
+    bool Read( std::vector<char>& buffer ) const;
+
+private:
+// Not implemented
+    MemoryFile(const MemoryFile&);
+    MemoryFile& operator=(const MemoryFile&);
+
+    int m_Fd;
+    bool m_Unlink;
+    std::string m_FileName;
+};
+//END class n2d::tools::MemoryFile
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSMEMORYFILE_H
@@ -0,0 +1,242 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsPathTemplate.h"
+#include "n2dToolsHash.h"
+
+#include <itkMetaDataObject.h>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+
+//BEGIN DICOM tags
+const std::string seriesinstanceuidtag ( "0020|000e" );
+//END DICOM tags
+
+struct NamedTag
+{
+    const char* name;
+    const char* tag;
+};
+
+const NamedTag namedtags[] = {
+    { "StudyUID",        "0020|000d" },
+    { "SeriesUID",       "0020|000e" },
+    { "SeriesNumber",    "0020|0011" },
+    { "StudyID",         "0020|0010" },
+    { "PatientID",       "0010|0020" },
+    { "AccessionNumber", "0008|0050" },
+    { "Modality",        "0008|0060" },
+    { NULL,              NULL }
+};
+
+
+bool IsTagKey( const std::string& key )
+{
+    if (key.size() != 9 || key[4] != '|')
+        return false;
+    for (std::size_t i = 0; i < key.size(); ++i)
+        if (i != 4 && !std::isxdigit(static_cast<unsigned char>(key[i])))
+            return false;
+    return true;
+}
+
+
+// Keep only characters that are safe in file names on every platform,
+// DICOM values can contain spaces, slashes and trailing padding.
+std::string SafeName( const std::string& value )
+{
+    std::string::size_type begin = value.find_first_not_of(" \t");
+    std::string::size_type end = value.find_last_not_of(" \t\0", std::string::npos, 3);
+    if (begin == std::string::npos)
+        return "UNKNOWN";
+
+    std::string name;
+    bool onlyDots = true;
+    for (std::string::size_type i = begin; i <= end; ++i)
+    {
+        const char c = value[i];
+        const bool safe = std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_' || c == '+';
+        name += safe ? c : '_';
+        onlyDots = onlyDots && c == '.';
+    }
+    return onlyDots ? "_" : name;
+}
+
+
+} // namespace
+
+
+
+bool PathTemplate::Parse( const std::string& pathTemplate )
+{
+    m_Fields.clear();
+    m_Error.clear();
+
+    std::string::size_type pos = 0;
+    while (pos < pathTemplate.size())
+    {
+        const std::string::size_type open = pathTemplate.find('{', pos);
+        if (open != pos)
+        {
+            Field literal;
+            literal.type = Literal;
+            literal.value = pathTemplate.substr(pos, open - pos);
+            literal.width = 0;
+            if (literal.value.find('}') != std::string::npos)
+            {
+                m_Error = "unmatched '}'";
+                return false;
+            }
+            m_Fields.push_back(literal);
+            if (open == std::string::npos)
+                break;
+        }
+
+        const std::string::size_type close = pathTemplate.find('}', open);
+        if (close == std::string::npos)
+        {
+            m_Error = "unmatched '{'";
+            return false;
+        }
+
+        std::string name = pathTemplate.substr(open + 1, close - open - 1);
+        std::string format;
+        const std::string::size_type colon = name.find(':');
+        if (colon != std::string::npos)
+        {
+            format = name.substr(colon + 1);
+            name.erase(colon);
+        }
+
+        Field field;
+        field.width = 0;
+        if (!format.empty())
+        {
+            if (format.find_first_not_of("0123456789") != std::string::npos)
+            {
+                m_Error = "invalid format \"" + format + "\" in {" + name + "}";
+                return false;
+            }
+            field.width = static_cast<unsigned int>(std::atoi(format.c_str()));
+        }
+
+        if (name == "Instance")
+        {
+            field.type = Instance;
+        }
+        else if (name == "Shard")
+        {
+            field.type = Shard;
+            if (field.width == 0 || field.width > 16)
+            {
+                m_Error = "{Shard:N} needs a number of digits between 1 and 16";
+                return false;
+            }
+        }
+        else if (IsTagKey(name))
+        {
+            // Keys of the dictionary are lowercase
+            field.type = Tag;
+            field.value = name;
+            for (std::size_t i = 0; i < field.value.size(); ++i)
+                field.value[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(field.value[i])));
+        }
+        else
+        {
+            field.type = Tag;
+            for (const NamedTag* t = namedtags; t->name; ++t)
+                if (name == t->name)
+                    field.value = t->tag;
+            if (field.value.empty())
+            {
+                m_Error = "unknown field {" + name + "}";
+                return false;
+            }
+        }
+        m_Fields.push_back(field);
+        pos = close + 1;
+    }
+
+    if (m_Fields.empty())
+    {
+        m_Error = "empty template";
+        return false;
+    }
+
+    // Without the instance number, every slice would be written to the
+    // same path, overwriting the previous one.
+    bool instance = false;
+    for (std::size_t i = 0; i < m_Fields.size(); ++i)
+        instance = instance || m_Fields[i].type == Instance;
+    if (!instance)
+    {
+        m_Error = "the template needs an {Instance} field";
+        return false;
+    }
+    return true;
+}
+
+
+
+std::string PathTemplate::Expand( const DictionaryType& dict, unsigned long long instance ) const
+{
+    std::ostringstream path;
+    for (std::size_t i = 0; i < m_Fields.size(); ++i)
+    {
+        const Field& field = m_Fields[i];
+        switch (field.type)
+        {
+            case Literal:
+                path << field.value;
+                break;
+            case Instance:
+                path << std::setfill('0') << std::setw(field.width) << instance;
+                break;
+            case Shard:
+            {
+                std::string seriesInstanceUID;
+                itk::ExposeMetaData<std::string>(dict, seriesinstanceuidtag, seriesInstanceUID);
+                Hash hash;
+                hash.Update(seriesInstanceUID.data(), seriesInstanceUID.size());
+                path << hash.GetHexDigest().substr(0, field.width);
+                break;
+            }
+            case Tag:
+            {
+                std::string value;
+                itk::ExposeMetaData<std::string>(dict, field.value, value);
+                path << SafeName(value);
+                break;
+            }
+        }
+    }
+    return path.str();
+}
+
+} // namespace tools
+} // namespace n2d
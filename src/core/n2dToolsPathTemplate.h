@@ -0,0 +1,88 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSPATHTEMPLATE_H
+#define N2DTOOLSPATHTEMPLATE_H
+
+#include "n2dDefsMetadata.h"
+
+#include <string>
+#include <vector>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::PathTemplate
+/*!
+ * \brief Builds the path of each slice from a template filled with DICOM tags
+ *
+ * Fields between braces are replaced, everything else is copied:
+ *   - {Instance} Instance number, {Instance:05} pads it with zeros to 5 digits.
+ *   - {StudyUID}, {SeriesUID}, {SeriesNumber}, {StudyID}, {PatientID},
+ *     {AccessionNumber}, {Modality} The value of the corresponding tag.
+ *   - {gggg|eeee} The value of any tag.
+ *   - {Shard:N} N hex digits of a hash of the Series Instance UID, used to
+ *     spread many series over a fixed number of subdirectories.
+ *
+ * The template must contain {Instance}, for example
+ * "{StudyUID}/{SeriesNumber}/{Instance:05}.dcm". Tag values are
+ * made safe for file names, empty values are replaced by "UNKNOWN".
+ */
+class PathTemplate
+{
+public:
+    PathTemplate() {}
+
+/*!
+ * \brief Parse a template.
+ *
+ * \return false if the template is not valid, see GetError().
+ */
+    bool Parse( const std::string& pathTemplate );
+
+    inline const std::string& GetError( void ) const { return m_Error; }
+
+/*!
+ * \brief Build the path of a slice.
+ *
+ * \param dict Dictionary of the slice.
+ * \param instance Instance number of the slice.
+ */
+    std::string Expand( const DictionaryType& dict, unsigned long long instance ) const;
+
+private:
+    enum FieldType { Literal, Tag, Instance, Shard };
+
+    struct Field
+    {
+        FieldType type;
+        std::string value; //!< Text for literals, tag key for tags
+        unsigned int width;
+    };
+
+    std::vector<Field> m_Fields;
+    std::string m_Error;
+};
+//END class n2d::tools::PathTemplate
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSPATHTEMPLATE_H
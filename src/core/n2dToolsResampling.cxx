@@ -0,0 +1,97 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsResampling.h"
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+
+namespace n2d {
+namespace tools {
+
+bool ParseResampling( const std::string& value, std::string& mode, double values[3] )
+{
+    const std::string::size_type colon = value.find(':');
+    if (colon == std::string::npos)
+        return false;
+
+    mode = value.substr(0, colon);
+    if (mode != "spacing" && mode != "size")
+        return false;
+
+    // One or three values separated by commas
+    std::vector<std::string> fields;
+    std::string::size_type begin = colon + 1;
+    std::string::size_type comma;
+    while ((comma = value.find(',', begin)) != std::string::npos)
+    {
+        fields.push_back(value.substr(begin, comma - begin));
+        begin = comma + 1;
+    }
+    fields.push_back(value.substr(begin));
+    if (fields.size() != 1 && fields.size() != 3)
+        return false;
+
+    bool any = false;
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+        const std::string& field = fields[fields.size() == 1 ? 0 : k];
+        char* end;
+        values[k] = std::strtod(field.c_str(), &end);
+        if (field.empty() || *end != '\0' || !(values[k] >= 0) || std::isinf(values[k]))
+            return false;
+        if (mode == "size" && values[k] != std::floor(values[k]))
+            return false;
+        any = any || values[k] > 0;
+    }
+    return any;
+}
+
+
+
+void GetResampledGrid( const std::string& mode, const double values[3],
+                       const unsigned long long size[3], const double spacing[3],
+                       unsigned long long resampledSize[3], double resampledSpacing[3] )
+{
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+        resampledSize[k] = size[k];
+        resampledSpacing[k] = spacing[k];
+        if (values[k] <= 0)
+            continue;
+
+        if (mode == "spacing")
+        {
+            const double count = std::floor(size[k] * spacing[k] / values[k] + 0.5);
+            resampledSize[k] = count < 1 ? 1 : static_cast<unsigned long long>(count);
+            resampledSpacing[k] = values[k];
+        }
+        else
+        {
+            resampledSize[k] = static_cast<unsigned long long>(values[k]);
+            resampledSpacing[k] = spacing[k] * size[k] / values[k];
+        }
+    }
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,54 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSRESAMPLING_H
+#define N2DTOOLSRESAMPLING_H
+
+#include <string>
+
+namespace n2d {
+namespace tools {
+
+/*!
+ * \brief Parse a resampling written as "spacing:x,y,z" or "size:x,y,z".
+ *
+ * A single value ("spacing:1") is used for the three axes. A value equal to
+ * 0 keeps the spacing and size of that axis. Sizes are integers.
+ *
+ * \param mode Set to "spacing" or "size".
+ * \return false if the resampling is not valid.
+ */
+bool ParseResampling( const std::string& value, std::string& mode, double values[3] );
+
+/*!
+ * \brief Get the size and spacing of a resampled image.
+ *
+ * The resampled image covers the same extent as the image: with \c mode
+ * "spacing" the size of each axis is rounded to the nearest integer (at
+ * least 1), with \c mode "size" the spacing is computed from the size.
+ */
+void GetResampledGrid( const std::string& mode, const double values[3],
+                       const unsigned long long size[3], const double spacing[3],
+                       unsigned long long resampledSize[3], double resampledSpacing[3] );
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSRESAMPLING_H
@@ -0,0 +1,120 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsSliceHeaderIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+// Output slices whose normal differs by more than about 2.5 degrees are not
+// considered parallel to the reference slices.
+const double minnormaldot = 0.999;
+// Positions are matched within this fraction of the slice spacing, so that
+// rounding in the input image does not matter.
+const double spacingtolerance = 0.1;
+// Tolerance in mm used when the spacing is not known (single slice).
+const double defaulttolerance = 0.01;
+} // namespace
+
+
+
+SliceHeaderIndex::SliceHeaderIndex() :
+        m_Tolerance(defaulttolerance)
+{
+    m_Normal[0] = m_Normal[1] = 0.0;
+    m_Normal[2] = 1.0;
+}
+
+
+
+void SliceHeaderIndex::Reset( const double normal[3] )
+{
+    for (int i = 0; i < 3; ++i)
+        m_Normal[i] = normal[i];
+    m_Tolerance = defaulttolerance;
+    m_Slices.clear();
+}
+
+
+
+void SliceHeaderIndex::Add( double position, const DictionaryType& dict )
+{
+    m_Slices.push_back(SliceType(position, dict));
+}
+
+
+
+bool SliceHeaderIndex::ComparePosition( const SliceType& a, const SliceType& b )
+{
+    return a.first < b.first;
+}
+
+
+
+void SliceHeaderIndex::Update( void )
+{
+    std::sort(m_Slices.begin(), m_Slices.end(), ComparePosition);
+
+    // The smallest distance between two different slices
+    double spacing = 0.0;
+    for (std::size_t i = 1; i < m_Slices.size(); ++i)
+    {
+        const double distance = m_Slices[i].first - m_Slices[i - 1].first;
+        if (distance > defaulttolerance && (spacing == 0.0 || distance < spacing))
+            spacing = distance;
+    }
+    m_Tolerance = spacing > 0.0 ? spacing * spacingtolerance : defaulttolerance;
+}
+
+
+
+const DictionaryType* SliceHeaderIndex::Find( const ImageType::PointType& origin, const ImageType::DirectionType& direction ) const
+{
+    if (m_Slices.empty())
+        return NULL;
+
+    double dot = 0.0;
+    for (int i = 0; i < 3; ++i)
+        dot += direction[i][2] * m_Normal[i];
+    if (std::fabs(dot) < minnormaldot)
+        return NULL;
+
+    double position = 0.0;
+    for (int i = 0; i < 3; ++i)
+        position += origin[i] * m_Normal[i];
+
+    const SliceType key(position, DictionaryType());
+    std::vector<SliceType>::const_iterator next = std::lower_bound(m_Slices.begin(), m_Slices.end(), key, ComparePosition);
+    std::vector<SliceType>::const_iterator nearest = next;
+    if (next == m_Slices.end() || (next != m_Slices.begin() && position - (next - 1)->first < next->first - position))
+        nearest = next - 1;
+
+    if (std::fabs(nearest->first - position) > m_Tolerance)
+        return NULL;
+    return &nearest->second;
+}
+
+} // namespace tools
+} // namespace n2d
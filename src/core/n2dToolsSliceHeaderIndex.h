@@ -0,0 +1,92 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSLICEHEADERINDEX_H
+#define N2DTOOLSSLICEHEADERINDEX_H
+
+#include "n2dDefsImage.h"
+#include "n2dDefsMetadata.h"
+
+#include <vector>
+#include <utility>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::SliceHeaderIndex
+/*!
+ * \brief Per-slice DICOM attributes of a reference series, indexed by position
+ *
+ * Each slice of the reference series is stored with its position along the
+ * normal of the series, so that the attributes can be copied to the output
+ * slice at the same position.
+ */
+class SliceHeaderIndex
+{
+public:
+    SliceHeaderIndex();
+
+/*!
+ * \brief Set the normal of the reference series and remove all the slices.
+ */
+    void Reset( const double normal[3] );
+
+/*!
+ * \brief Add the attributes of the slice at \c position along the normal.
+ */
+    void Add( double position, const DictionaryType& dict );
+
+/*!
+ * \brief Sort the slices, must be called after all the slices were added.
+ */
+    void Update( void );
+
+/*!
+ * \brief Find the slice at the same position of an output slice.
+ *
+ * \param origin Position of the first voxel of the output slice.
+ * \param direction Direction of the output image, whose third column is
+ *        the normal of the output slices.
+ * \return NULL if the output slices are not parallel to the reference
+ *         slices, or if no reference slice is close enough.
+ */
+    const DictionaryType* Find( const ImageType::PointType& origin, const ImageType::DirectionType& direction ) const;
+
+    inline bool IsEmpty( void ) const { return m_Slices.empty(); }
+    inline unsigned int GetNumberOfSlices( void ) const { return static_cast<unsigned int>(m_Slices.size()); }
+    inline const double* GetNormal( void ) const { return m_Normal; }
+    inline double GetSlicePosition( unsigned int i ) const { return m_Slices[i].first; }
+    inline const DictionaryType& GetSliceDictionary( unsigned int i ) const { return m_Slices[i].second; }
+
+private:
+    typedef std::pair<double, DictionaryType> SliceType;
+
+    static bool ComparePosition( const SliceType& a, const SliceType& b );
+
+    double m_Normal[3];
+    double m_Tolerance; //!< Maximum distance from a reference slice, a fraction of the slice spacing
+    std::vector<SliceType> m_Slices;
+};
+//END class n2d::tools::SliceHeaderIndex
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSLICEHEADERINDEX_H
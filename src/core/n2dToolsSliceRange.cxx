@@ -0,0 +1,47 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsSliceRange.h"
+
+#include <cstdlib>
+
+
+namespace n2d {
+namespace tools {
+
+bool ParseSliceRange( const std::string& value, unsigned long long& start, unsigned long long& end )
+{
+    const std::string::size_type colon = value.find(':');
+    if (colon == std::string::npos || colon == 0)
+        return false;
+
+    const std::string startStr = value.substr(0, colon);
+    const std::string endStr = value.substr(colon + 1);
+    if (startStr.find_first_not_of("0123456789") != std::string::npos ||
+        endStr.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+
+    start = std::strtoull(startStr.c_str(), NULL, 10);
+    end = endStr.empty() ? 0 : std::strtoull(endStr.c_str(), NULL, 10);
+    return endStr.empty() || end > start;
+}
+
+} // namespace tools
+} // namespace n2d
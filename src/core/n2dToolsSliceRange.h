@@ -0,0 +1,69 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSLICERANGE_H
+#define N2DTOOLSSLICERANGE_H
+
+#include <string>
+
+namespace n2d {
+namespace tools {
+
+/*!
+ * \brief Parse a slice range written as "start:end".
+ *
+ * Slices are counted from 0 and \c end is excluded, so that consecutive
+ * ranges (e.g. "0:100" and "100:200") do not overlap. If \c end is omitted
+ * ("100:") the range ends with the last slice and \c end is set to 0.
+ *
+ * \return false if the range is not valid.
+ */
+bool ParseSliceRange( const std::string& value, unsigned long long& start, unsigned long long& end );
+
+/*!
+ * \brief Get the region containing the slices [start, end) of an image.
+ *
+ * The range is taken along the third axis of the largest possible region
+ * of the image, an \c end equal to 0 or beyond the last slice means the
+ * last slice. The index of the region is preserved, so slices keep their
+ * position in the whole volume.
+ *
+ * \return false if the image has no slice in the range.
+ */
+template<class TImage>
+bool GetSliceRegion( const TImage* image, unsigned long long start, unsigned long long end, typename TImage::RegionType& region )
+{
+    region = image->GetLargestPossibleRegion();
+    const unsigned long long first = region.GetIndex()[2];
+    const unsigned long long last = first + region.GetSize()[2];
+    const unsigned long long rangeEnd = end == 0 ? last : (end < last ? end : last);
+
+    if (start < first || start >= rangeEnd)
+        return false;
+
+    region.SetIndex(2, start);
+    region.SetSize(2, rangeEnd - start);
+    return true;
+}
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSLICERANGE_H
@@ -0,0 +1,270 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsSocket.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef _WIN32
+ #include <winsock2.h>
+ #include <ws2tcpip.h>
+#else
+ #include <sys/types.h>
+ #include <sys/socket.h>
+ #include <sys/time.h>
+ #include <netinet/in.h>
+ #include <netinet/tcp.h>
+ #include <netdb.h>
+ #include <unistd.h>
+ #include <cerrno>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+#ifdef _WIN32
+namespace {
+// Winsock must be initialized once before any other call
+struct WinsockInitializer
+{
+    WinsockInitializer() { WSADATA data; WSAStartup(MAKEWORD(2, 2), &data); }
+    ~WinsockInitializer() { WSACleanup(); }
+};
+WinsockInitializer winsockinitializer;
+} // namespace
+#endif
+
+
+
+Socket::Socket() :
+        m_Socket(InvalidSocket),
+        m_Timeout(0)
+{
+}
+
+
+
+Socket::~Socket()
+{
+    Close();
+}
+
+
+
+bool Socket::ParseAddress( const std::string& address, std::string& host, unsigned short& port )
+{
+    const std::string::size_type colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size())
+        return false;
+
+    const std::string portStr = address.substr(colon + 1);
+    if (portStr.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+    const unsigned long value = std::strtoul(portStr.c_str(), NULL, 10);
+    if (value == 0 || value > 65535)
+        return false;
+
+    host = address.substr(0, colon);
+    // IPv6 addresses are written as [address]:port
+    if (host.size() > 2 && host[0] == '[' && host[host.size() - 1] == ']')
+        host = host.substr(1, host.size() - 2);
+    port = static_cast<unsigned short>(value);
+    return true;
+}
+
+
+
+bool Socket::Connect( const std::string& host, unsigned short port, unsigned int timeout )
+{
+    Close();
+
+    std::ostringstream service;
+    service << port;
+    m_Address = host + ":" + service.str();
+    m_Timeout = timeout;
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addresses = NULL;
+    const int error = getaddrinfo(host.c_str(), service.str().c_str(), &hints, &addresses);
+    if (error != 0)
+    {
+        std::cerr << "ERROR: Cannot resolve \"" << host << "\": " << gai_strerror(error) << std::endl;
+        return false;
+    }
+
+    for (struct addrinfo* address = addresses; address; address = address->ai_next)
+    {
+        m_Socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (m_Socket == InvalidSocket)
+            continue;
+        // On Linux the send timeout also bounds connect()
+        if (!SetTimeout(timeout))
+        {
+            Close();
+            continue;
+        }
+        if (connect(m_Socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+            break;
+        Close();
+    }
+    freeaddrinfo(addresses);
+
+    if (m_Socket == InvalidSocket)
+    {
+        std::cerr << "ERROR: Cannot connect to " << m_Address << std::endl;
+        return false;
+    }
+
+    // Requests are written in full before waiting for an answer
+    int noDelay = 1;
+    setsockopt(m_Socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    return true;
+}
+
+
+
+bool Socket::SetTimeout( unsigned int timeout )
+{
+#ifdef _WIN32
+    const DWORD value = timeout * 1000;
+#else
+    struct timeval value;
+    value.tv_sec = timeout;
+    value.tv_usec = 0;
+#endif
+    return setsockopt(m_Socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value)) == 0 &&
+           setsockopt(m_Socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&value), sizeof(value)) == 0;
+}
+
+
+
+void Socket::ReportTimeout( void ) const
+{
+    // Send and receive timeouts (SO_SNDTIMEO, SO_RCVTIMEO) fail with these
+#ifdef _WIN32
+    const bool timedOut = (WSAGetLastError() == WSAETIMEDOUT);
+#else
+    const bool timedOut = (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+    if (timedOut)
+        std::cerr << "ERROR: " << m_Address << " did not answer within " << m_Timeout << " seconds." << std::endl;
+}
+
+
+
+bool Socket::Send( const void* data, std::size_t size )
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+#ifdef _WIN32
+        const int chunk = size > 0x40000000 ? 0x40000000 : static_cast<int>(size);
+        const int sent = send(m_Socket, bytes, chunk, 0);
+        if (sent < 0)
+            ReportTimeout();
+        if (sent <= 0)
+            return false;
+#else
+ #ifdef MSG_NOSIGNAL
+        const ssize_t sent = send(m_Socket, bytes, size, MSG_NOSIGNAL);
+ #else
+        const ssize_t sent = send(m_Socket, bytes, size, 0);
+ #endif
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0)
+            ReportTimeout();
+        if (sent <= 0)
+            return false;
+#endif
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+
+
+long Socket::ReceiveSome( void* data, std::size_t size )
+{
+#ifdef _WIN32
+    const int chunk = size > 0x40000000 ? 0x40000000 : static_cast<int>(size);
+    const int received = recv(m_Socket, static_cast<char*>(data), chunk, 0);
+    if (received < 0)
+    {
+        ReportTimeout();
+        return -1;
+    }
+    return received;
+#else
+    ssize_t received;
+    do
+    {
+        received = recv(m_Socket, data, size, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0)
+    {
+        ReportTimeout();
+        return -1;
+    }
+    return static_cast<long>(received);
+#endif
+}
+
+
+
+bool Socket::Receive( void* data, std::size_t size )
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0)
+    {
+        const long received = ReceiveSome(bytes, size);
+        if (received <= 0)
+            return false;
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+
+
+void Socket::Close( void )
+{
+    if (m_Socket == InvalidSocket)
+        return;
+#ifdef _WIN32
+    closesocket(m_Socket);
+#else
+    close(m_Socket);
+#endif
+    m_Socket = InvalidSocket;
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,107 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSOCKET_H
+#define N2DTOOLSSOCKET_H
+
+#include <string>
+#include <cstddef>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::Socket
+/*!
+ * \brief Blocking TCP client connection
+ */
+class Socket
+{
+public:
+    Socket();
+    ~Socket();
+
+/*!
+ * \brief Connect to a server.
+ *
+ * \param timeout Seconds to wait for the connection, and then for each send
+ *        or receive, before failing with an error. 0 waits forever.
+ * \return true on success.
+ */
+    bool Connect( const std::string& host, unsigned short port, unsigned int timeout );
+
+/*!
+ * \brief Send all the data.
+ *
+ * \return true on success.
+ */
+    bool Send( const void* data, std::size_t size );
+
+/*!
+ * \brief Receive exactly \c size bytes.
+ *
+ * \return false on error or if the connection was closed before.
+ */
+    bool Receive( void* data, std::size_t size );
+
+/*!
+ * \brief Receive at most \c size bytes.
+ *
+ * \return The number of bytes received, 0 if the connection was closed,
+ *         -1 on error.
+ */
+    long ReceiveSome( void* data, std::size_t size );
+
+    void Close( void );
+
+    inline bool IsConnected( void ) const { return m_Socket != InvalidSocket; }
+
+/*!
+ * \brief Split "host:port".
+ *
+ * \return false if the address is not valid.
+ */
+    static bool ParseAddress( const std::string& address, std::string& host, unsigned short& port );
+
+private:
+// Not implemented
+    Socket(const Socket&);
+    Socket& operator=(const Socket&);
+
+#ifdef _WIN32
+    typedef unsigned long long SocketType; // SOCKET
+    static const SocketType InvalidSocket = ~0ULL;
+#else
+    typedef int SocketType;
+    static const SocketType InvalidSocket = -1;
+#endif
+
+    bool SetTimeout( unsigned int timeout );
+    void ReportTimeout( void ) const;
+
+    SocketType m_Socket;
+    std::string m_Address; //!< "host:port" of the server, used in messages
+    unsigned int m_Timeout;
+};
+//END class n2d::tools::Socket
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSOCKET_H
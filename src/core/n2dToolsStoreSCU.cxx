@@ -0,0 +1,695 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsStoreSCU.h"
+
+#include <gdcmUIDGenerator.h>
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+
+const char applicationcontext[] = "1.2.840.10008.3.1.1.1"; // DICOM Application Context Name
+const char defaultversionname[] = "NIFTI2DICOM";
+
+const unsigned int maxreceivedpdu = 0x10000;    // Maximum PDU length proposed to the SCP
+const std::size_t maxacceptedpdu = 0x1000000;   // Larger PDUs received are considered an error
+const std::size_t unlimitedpdu = 0x400000;      // PDU length used if the SCP does not set a maximum
+const unsigned int queuedepth = 4;              // Objects waiting to be sent
+
+// PDU types
+const unsigned char associaterq = 0x01;
+const unsigned char associateac = 0x02;
+const unsigned char associaterj = 0x03;
+const unsigned char pdatatf     = 0x04;
+const unsigned char releaserq   = 0x05;
+const unsigned char releaserp   = 0x06;
+const unsigned char abortrq     = 0x07;
+
+const unsigned short cstorerq  = 0x0001;
+const unsigned short cstorersp = 0x8001;
+
+
+void PutUInt16BE( std::vector<char>& buffer, unsigned int value )
+{
+    buffer.push_back(static_cast<char>((value >> 8) & 0xff));
+    buffer.push_back(static_cast<char>(value & 0xff));
+}
+
+
+void PutUInt32BE( std::vector<char>& buffer, unsigned long value )
+{
+    PutUInt16BE(buffer, (value >> 16) & 0xffff);
+    PutUInt16BE(buffer, value & 0xffff);
+}
+
+
+void PutUInt16LE( std::vector<char>& buffer, unsigned int value )
+{
+    buffer.push_back(static_cast<char>(value & 0xff));
+    buffer.push_back(static_cast<char>((value >> 8) & 0xff));
+}
+
+
+void PutUInt32LE( std::vector<char>& buffer, unsigned long value )
+{
+    PutUInt16LE(buffer, value & 0xffff);
+    PutUInt16LE(buffer, (value >> 16) & 0xffff);
+}
+
+
+unsigned int GetUInt16BE( const char* data )
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return (static_cast<unsigned int>(bytes[0]) << 8) | bytes[1];
+}
+
+
+unsigned long GetUInt32BE( const char* data )
+{
+    return (static_cast<unsigned long>(GetUInt16BE(data)) << 16) | GetUInt16BE(data + 2);
+}
+
+
+unsigned int GetUInt16LE( const char* data )
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return (static_cast<unsigned int>(bytes[1]) << 8) | bytes[0];
+}
+
+
+unsigned long GetUInt32LE( const char* data )
+{
+    return (static_cast<unsigned long>(GetUInt16LE(data + 2)) << 16) | GetUInt16LE(data);
+}
+
+
+// Appends an item of an A-ASSOCIATE PDU: type, reserved, 16 bit length, value
+void PutItem( std::vector<char>& buffer, unsigned char type, const std::string& value )
+{
+    buffer.push_back(static_cast<char>(type));
+    buffer.push_back(0);
+    PutUInt16BE(buffer, static_cast<unsigned int>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+
+// AE titles are padded with spaces to 16 bytes
+void PutAETitle( std::vector<char>& buffer, const std::string& aet )
+{
+    std::string padded(aet);
+    padded.resize(16, ' ');
+    buffer.insert(buffer.end(), padded.begin(), padded.end());
+}
+
+
+// Appends an element of a command set, encoded in Implicit VR Little Endian
+void PutCommandElement( std::vector<char>& buffer, unsigned int element, const std::string& value )
+{
+    PutUInt16LE(buffer, 0x0000);
+    PutUInt16LE(buffer, element);
+    PutUInt32LE(buffer, static_cast<unsigned long>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+
+void PutCommandUS( std::vector<char>& buffer, unsigned int element, unsigned int value )
+{
+    std::vector<char> bytes;
+    PutUInt16LE(bytes, value);
+    PutCommandElement(buffer, element, std::string(bytes.begin(), bytes.end()));
+}
+
+
+// UIDs are padded with a NULL byte to an even length
+void PutCommandUI( std::vector<char>& buffer, unsigned int element, const std::string& uid )
+{
+    PutCommandElement(buffer, element, uid.size() % 2 ? uid + '\0' : uid);
+}
+
+
+std::string TrimValue( const char* data, std::size_t size )
+{
+    while (size > 0 && (data[size - 1] == '\0' || data[size - 1] == ' '))
+        --size;
+    return std::string(data, size);
+}
+
+
+/*
+ * Reads the File Meta Information of a DICOM Part 10 object (group 0002,
+ * always Explicit VR Little Endian) and returns the values of its elements
+ * by element number, together with the offset where the data set starts.
+ */
+bool ParseMetaInformation( const char* data, std::size_t size, std::map<unsigned int, std::string>& meta, std::size_t& datasetOffset )
+{
+    if (size < 132 || std::memcmp(data + 128, "DICM", 4) != 0)
+        return false;
+
+    std::size_t pos = 132;
+    while (pos + 8 <= size && GetUInt16LE(data + pos) == 0x0002)
+    {
+        const unsigned int element = GetUInt16LE(data + pos + 2);
+        const std::string vr(data + pos + 4, 2);
+        std::size_t header = 8;
+        std::size_t length = GetUInt16LE(data + pos + 6);
+        if (vr == "OB" || vr == "OW" || vr == "OF" || vr == "SQ" || vr == "UT" || vr == "UN")
+        {
+            if (pos + 12 > size)
+                return false;
+            header = 12;
+            length = GetUInt32LE(data + pos + 8);
+        }
+        if (length > size - pos - header)
+            return false;
+        meta[element] = TrimValue(data + pos + header, length);
+        pos += header + length;
+    }
+    datasetOffset = pos;
+    return meta.count(0x0002) && meta.count(0x0003) && meta.count(0x0010);
+}
+
+} // namespace
+
+
+
+StoreSCU::StoreSCU( const std::string& address, const std::string& calledAET, const std::string& callingAET, unsigned int window,
+                    unsigned int timeout ) :
+        m_Port(0),
+        m_CalledAET(calledAET),
+        m_CallingAET(callingAET),
+        m_ProposedWindow(window > 0 ? window : 1),
+        m_Timeout(timeout),
+        m_Associated(false),
+        m_PresentationContextID(1),
+        m_MaxPDV(0),
+        m_Window(1),
+        m_MessageID(0),
+        m_Done(false),
+        m_Error(false)
+{
+    Socket::ParseAddress(address, m_Host, m_Port);
+}
+
+
+
+StoreSCU::~StoreSCU()
+{
+    if (m_Thread.joinable())
+        Close();
+}
+
+
+
+bool StoreSCU::IsValidAETitle( const std::string& aet )
+{
+    if (aet.empty() || aet.size() > 16 || aet.find_first_not_of(' ') == std::string::npos)
+        return false;
+    for (std::string::size_type i = 0; i < aet.size(); ++i)
+        if (aet[i] == '\\' || static_cast<unsigned char>(aet[i]) < 0x20 || static_cast<unsigned char>(aet[i]) > 0x7e)
+            return false;
+    return true;
+}
+
+
+
+bool StoreSCU::Open( void )
+{
+    if (m_Host.empty())
+    {
+        std::cerr << "ERROR: Invalid Storage SCP address." << std::endl;
+        return false;
+    }
+    m_Done = false;
+    m_Error = false;
+    m_Thread = std::thread(&StoreSCU::Sender, this);
+    return true;
+}
+
+
+
+bool StoreSCU::Store( const std::string& name, const char* data, std::size_t size )
+{
+    Job* job = new Job;
+    job->name = name;
+    job->data.assign(data, data + size);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (!m_Error && m_Queue.size() >= queuedepth)
+        m_QueueNotFull.wait(lock);
+    if (m_Error)
+    {
+        delete job;
+        return false;
+    }
+    m_Queue.push_back(job);
+    m_QueueNotEmpty.notify_one();
+    return true;
+}
+
+
+
+bool StoreSCU::Close( void )
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Done = true;
+        m_QueueNotEmpty.notify_one();
+    }
+    if (m_Thread.joinable())
+        m_Thread.join();
+    return !m_Error;
+}
+
+
+
+void StoreSCU::Sender( void )
+{
+    bool error = false;
+    for (;;)
+    {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (m_Queue.empty() && !m_Done)
+                m_QueueNotEmpty.wait(lock);
+            if (m_Queue.empty())
+                break;
+            job = m_Queue.front();
+            m_Queue.pop_front();
+            m_QueueNotFull.notify_one();
+        }
+
+        // After an error the remaining objects are discarded
+        if (!error && !Send(job))
+        {
+            error = true;
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Error = true;
+            m_QueueNotFull.notify_all();
+        }
+        delete job;
+    }
+
+    if (m_Associated && (error || !Release()))
+    {
+        Abort();
+        error = true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Error = m_Error || error;
+}
+
+
+
+bool StoreSCU::Send( Job* job )
+{
+    std::map<unsigned int, std::string> meta;
+    std::size_t datasetOffset;
+    if (!ParseMetaInformation(job->data.empty() ? NULL : &job->data[0], job->data.size(), meta, datasetOffset))
+    {
+        std::cerr << "ERROR: \"" << job->name << "\" is not a valid DICOM Part 10 object." << std::endl;
+        return false;
+    }
+
+    const std::string& sopClass = meta[0x0002];
+    if (!m_Associated)
+    {
+        if (!Associate(sopClass, meta[0x0010], meta[0x0012], meta[0x0013]))
+            return false;
+    }
+    else if (sopClass != m_SOPClass)
+    {
+        std::cerr << "ERROR: \"" << job->name << "\" has SOP Class " << sopClass
+                  << ", but the association was negotiated for " << m_SOPClass << "." << std::endl;
+        return false;
+    }
+
+    // Keep at most the number of outstanding requests accepted by the SCP
+    while (m_Pending.size() >= m_Window)
+        if (!ReceiveResponse())
+            return false;
+
+    if (++m_MessageID == 0)
+        ++m_MessageID;
+
+    std::vector<char> elements;
+    PutCommandUI(elements, 0x0002, sopClass);   // Affected SOP Class UID
+    PutCommandUS(elements, 0x0100, cstorerq);   // Command Field
+    PutCommandUS(elements, 0x0110, m_MessageID);// Message ID
+    PutCommandUS(elements, 0x0700, 0x0000);     // Priority: medium
+    PutCommandUS(elements, 0x0800, 0x0000);     // Command Data Set Type: present
+    PutCommandUI(elements, 0x1000, meta[0x0003]); // Affected SOP Instance UID
+
+    std::vector<char> command;
+    PutUInt16LE(command, 0x0000);               // Command Group Length
+    PutUInt16LE(command, 0x0000);
+    PutUInt32LE(command, 4);
+    PutUInt32LE(command, static_cast<unsigned long>(elements.size()));
+    command.insert(command.end(), elements.begin(), elements.end());
+
+    if (!SendPDataTF(&command[0], command.size(), true) ||
+        !SendPDataTF(&job->data[0] + datasetOffset, job->data.size() - datasetOffset, false))
+    {
+        std::cerr << "ERROR: Cannot send \"" << job->name << "\" to " << m_Host << ":" << m_Port << "." << std::endl;
+        return false;
+    }
+    m_Pending[m_MessageID] = job->name;
+    return true;
+}
+
+
+
+bool StoreSCU::Associate( const std::string& sopClass, const std::string& transferSyntax,
+                          const std::string& implementationUID, const std::string& implementationVersion )
+{
+    if (!m_Socket.Connect(m_Host, m_Port, m_Timeout))
+        return false;
+
+    std::vector<char> body;
+    PutUInt16BE(body, 0x0001);                  // Protocol version
+    PutUInt16BE(body, 0x0000);
+    PutAETitle(body, m_CalledAET);
+    PutAETitle(body, m_CallingAET);
+    body.resize(body.size() + 32, 0);
+
+    PutItem(body, 0x10, applicationcontext);
+
+    // A single presentation context with the SOP Class and Transfer Syntax
+    // the slices were encoded with, there is no transcoding.
+    std::vector<char> context;
+    context.push_back(static_cast<char>(m_PresentationContextID));
+    context.resize(4, 0);
+    PutItem(context, 0x30, sopClass);
+    PutItem(context, 0x40, transferSyntax);
+    PutItem(body, 0x20, std::string(context.begin(), context.end()));
+
+    std::vector<char> userInfo;
+    std::vector<char> value;
+    PutUInt32BE(value, maxreceivedpdu);
+    PutItem(userInfo, 0x51, std::string(value.begin(), value.end()));
+    PutItem(userInfo, 0x52, implementationUID.empty() ? std::string(gdcm::UIDGenerator::GetGDCMUID()) : implementationUID);
+    if (m_ProposedWindow > 1)
+    {
+        // Asynchronous Operations Window: invoked by us, performed by us
+        value.clear();
+        PutUInt16BE(value, m_ProposedWindow > 0xffff ? 0xffff : m_ProposedWindow);
+        PutUInt16BE(value, 1);
+        PutItem(userInfo, 0x53, std::string(value.begin(), value.end()));
+    }
+    PutItem(userInfo, 0x55, (implementationVersion.empty() ? std::string(defaultversionname) : implementationVersion).substr(0, 16));
+    PutItem(body, 0x50, std::string(userInfo.begin(), userInfo.end()));
+
+    std::vector<char> pdu;
+    pdu.push_back(static_cast<char>(associaterq));
+    pdu.push_back(0);
+    PutUInt32BE(pdu, static_cast<unsigned long>(body.size()));
+    pdu.insert(pdu.end(), body.begin(), body.end());
+
+    unsigned char type;
+    if (!m_Socket.Send(&pdu[0], pdu.size()) || !ReceivePDU(type, body))
+    {
+        std::cerr << "ERROR: Cannot associate with " << m_Host << ":" << m_Port << "." << std::endl;
+        m_Socket.Close();
+        return false;
+    }
+
+    if (type == associaterj && body.size() >= 4)
+    {
+        std::cerr << "ERROR: Association rejected by " << m_CalledAET << " (result " << GetUInt16BE(&body[0]) % 256
+                  << ", source " << static_cast<unsigned int>(static_cast<unsigned char>(body[2]))
+                  << ", reason " << static_cast<unsigned int>(static_cast<unsigned char>(body[3])) << ")." << std::endl;
+        m_Socket.Close();
+        return false;
+    }
+    if (type != associateac || body.size() < 68)
+    {
+        std::cerr << "ERROR: Unexpected answer to the association request from " << m_Host << ":" << m_Port << "." << std::endl;
+        m_Socket.Close();
+        return false;
+    }
+
+    int contextResult = -1;
+    unsigned long maxPDU = 0;
+    unsigned int window = 1; // Without the Asynchronous Operations Window, operations are synchronous
+    for (std::size_t pos = 68; pos + 4 <= body.size(); )
+    {
+        const unsigned char itemType = static_cast<unsigned char>(body[pos]);
+        const std::size_t itemLength = GetUInt16BE(&body[pos + 2]);
+        const char* item = &body[pos + 4];
+        if (pos + 4 + itemLength > body.size())
+            break;
+
+        if (itemType == 0x21 && itemLength >= 4 && static_cast<unsigned char>(item[0]) == m_PresentationContextID)
+            contextResult = static_cast<unsigned char>(item[2]);
+        else if (itemType == 0x50)
+        {
+            for (std::size_t sub = 0; sub + 4 <= itemLength; )
+            {
+                const unsigned char subType = static_cast<unsigned char>(item[sub]);
+                const std::size_t subLength = GetUInt16BE(item + sub + 2);
+                if (sub + 4 + subLength > itemLength)
+                    break;
+                if (subType == 0x51 && subLength == 4)
+                    maxPDU = GetUInt32BE(item + sub + 4);
+                else if (subType == 0x53 && subLength == 4)
+                    window = GetUInt16BE(item + sub + 6); // Operations performed by the SCP
+                sub += 4 + subLength;
+            }
+        }
+        pos += 4 + itemLength;
+    }
+
+    if (contextResult != 0)
+    {
+        std::cerr << "ERROR: " << m_CalledAET << " does not accept SOP Class " << sopClass
+                  << " with Transfer Syntax " << transferSyntax << "." << std::endl;
+        m_Associated = true;
+        return false;
+    }
+
+    // 0 means unlimited
+    if (window == 0 || window > m_ProposedWindow)
+        window = m_ProposedWindow;
+    if (maxPDU == 0 || maxPDU > unlimitedpdu)
+        maxPDU = unlimitedpdu;
+    if (maxPDU <= 6)
+    {
+        std::cerr << "ERROR: Invalid maximum PDU length " << maxPDU << " from " << m_CalledAET << "." << std::endl;
+        m_Associated = true;
+        return false;
+    }
+
+    m_Associated = true;
+    m_SOPClass = sopClass;
+    m_MaxPDV = maxPDU - 6;
+    m_Window = window;
+    return true;
+}
+
+
+
+bool StoreSCU::SendPDataTF( const char* data, std::size_t size, bool command )
+{
+    do
+    {
+        const std::size_t chunk = size < m_MaxPDV ? size : m_MaxPDV;
+        const bool last = (chunk == size);
+
+        std::vector<char> header;
+        header.reserve(12);
+        header.push_back(static_cast<char>(pdatatf));
+        header.push_back(0);
+        PutUInt32BE(header, static_cast<unsigned long>(chunk + 6));
+        PutUInt32BE(header, static_cast<unsigned long>(chunk + 2));
+        header.push_back(static_cast<char>(m_PresentationContextID));
+        header.push_back(static_cast<char>((command ? 0x01 : 0x00) | (last ? 0x02 : 0x00)));
+
+        if (!m_Socket.Send(&header[0], header.size()) || (chunk > 0 && !m_Socket.Send(data, chunk)))
+            return false;
+        data += chunk;
+        size -= chunk;
+    } while (size > 0);
+    return true;
+}
+
+
+
+bool StoreSCU::ReceivePDU( unsigned char& type, std::vector<char>& body )
+{
+    char header[6];
+    if (!m_Socket.Receive(header, sizeof(header)))
+        return false;
+    type = static_cast<unsigned char>(header[0]);
+    const unsigned long length = GetUInt32BE(header + 2);
+    if (length > maxacceptedpdu)
+        return false;
+    body.resize(length);
+    return length == 0 || m_Socket.Receive(&body[0], length);
+}
+
+
+
+bool StoreSCU::ReceiveResponse( void )
+{
+    bool received = false;
+    while (!received)
+    {
+        unsigned char type;
+        std::vector<char> body;
+        if (!ReceivePDU(type, body))
+        {
+            std::cerr << "ERROR: Connection to " << m_Host << ":" << m_Port << " lost." << std::endl;
+            return false;
+        }
+        if (type == abortrq)
+        {
+            std::cerr << "ERROR: Association aborted by " << m_CalledAET << "." << std::endl;
+            m_Associated = false;
+            m_Socket.Close();
+            return false;
+        }
+        if (type != pdatatf)
+        {
+            std::cerr << "ERROR: Unexpected PDU (type " << static_cast<unsigned int>(type) << ") from " << m_CalledAET << "." << std::endl;
+            return false;
+        }
+
+        // Several responses can be packed in the same PDU
+        for (std::size_t pos = 0; pos + 6 <= body.size(); )
+        {
+            const std::size_t length = GetUInt32BE(&body[pos]);
+            if (length < 2 || pos + 4 + length > body.size())
+            {
+                std::cerr << "ERROR: Malformed PDU from " << m_CalledAET << "." << std::endl;
+                return false;
+            }
+            const unsigned char control = static_cast<unsigned char>(body[pos + 5]);
+            if (control & 0x01)
+                m_Response.insert(m_Response.end(), body.begin() + pos + 6, body.begin() + pos + 4 + length);
+            pos += 4 + length;
+            if (!(control & 0x01) || !(control & 0x02))
+                continue;
+
+            // Complete command set: look for Command Field, Message ID
+            // Being Responded To, Status and Error Comment
+            std::map<unsigned int, std::string> elements;
+            for (std::size_t e = 0; e + 8 <= m_Response.size(); )
+            {
+                const unsigned int group = GetUInt16LE(&m_Response[e]);
+                const unsigned int element = GetUInt16LE(&m_Response[e + 2]);
+                const std::size_t elementLength = GetUInt32LE(&m_Response[e + 4]);
+                if (elementLength > m_Response.size() - e - 8)
+                    break;
+                if (group == 0x0000)
+                    elements[element].assign(&m_Response[e + 8], elementLength);
+                e += 8 + elementLength;
+            }
+            m_Response.clear();
+
+            if (elements[0x0100].size() != 2 || GetUInt16LE(elements[0x0100].data()) != cstorersp ||
+                elements[0x0120].size() != 2 || elements[0x0900].size() != 2)
+            {
+                std::cerr << "ERROR: Unexpected response from " << m_CalledAET << "." << std::endl;
+                return false;
+            }
+
+            const unsigned short messageID = static_cast<unsigned short>(GetUInt16LE(elements[0x0120].data()));
+            const unsigned int status = GetUInt16LE(elements[0x0900].data());
+            std::map<unsigned short, std::string>::iterator pending = m_Pending.find(messageID);
+            if (pending == m_Pending.end())
+            {
+                std::cerr << "ERROR: Unexpected response to message " << messageID << " from " << m_CalledAET << "." << std::endl;
+                return false;
+            }
+
+            const std::string comment = TrimValue(elements[0x0902].data(), elements[0x0902].size());
+            // Warnings: coercion of data elements, elements discarded, data set does not match SOP Class
+            if (status == 0x0001 || (status & 0xf000) == 0xb000)
+                std::cerr << "WARNING: " << m_CalledAET << " stored \"" << pending->second << "\" with status 0x"
+                          << std::hex << std::setw(4) << std::setfill('0') << status << std::dec << std::setfill(' ')
+                          << (comment.empty() ? "" : ": ") << comment << std::endl;
+            else if (status != 0x0000)
+            {
+                std::cerr << "ERROR: " << m_CalledAET << " cannot store \"" << pending->second << "\", status 0x"
+                          << std::hex << std::setw(4) << std::setfill('0') << status << std::dec << std::setfill(' ')
+                          << (comment.empty() ? "" : ": ") << comment << std::endl;
+                return false;
+            }
+            m_Pending.erase(pending);
+            received = true;
+        }
+    }
+    return true;
+}
+
+
+
+bool StoreSCU::Release( void )
+{
+    while (!m_Pending.empty())
+        if (!ReceiveResponse())
+            return false;
+
+    std::vector<char> pdu;
+    pdu.push_back(static_cast<char>(releaserq));
+    pdu.push_back(0);
+    PutUInt32BE(pdu, 4);
+    PutUInt32BE(pdu, 0);
+
+    unsigned char type;
+    std::vector<char> body;
+    if (!m_Socket.Send(&pdu[0], pdu.size()) || !ReceivePDU(type, body) || type != releaserp)
+    {
+        std::cerr << "ERROR: Cannot release the association with " << m_CalledAET << "." << std::endl;
+        return false;
+    }
+    m_Socket.Close();
+    m_Associated = false;
+    return true;
+}
+
+
+
+void StoreSCU::Abort( void )
+{
+    if (m_Socket.IsConnected())
+    {
+        std::vector<char> pdu;
+        pdu.push_back(static_cast<char>(abortrq));
+        pdu.push_back(0);
+        PutUInt32BE(pdu, 4);
+        PutUInt32BE(pdu, 0); // Reserved, source: service user, reason: not specified
+        m_Socket.Send(&pdu[0], pdu.size());
+        m_Socket.Close();
+    }
+    m_Associated = false;
+    m_Pending.clear();
+}
+
+} // namespace tools
+} // namespace n2d
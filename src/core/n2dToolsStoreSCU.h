@@ -0,0 +1,143 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSTORESCU_H
+#define N2DTOOLSSTORESCU_H
+
+#include "n2dToolsSocket.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::StoreSCU
+/*!
+ * \brief Sends DICOM Part 10 objects to a Storage SCP with C-STORE requests
+ *
+ * Objects are queued by Store() and sent by a separate thread, so that the
+ * next object can be encoded while the previous ones are transferred. The
+ * association is opened when the first object is sent, using its SOP Class
+ * and Transfer Syntax, and reused for all the following objects until
+ * Close(). If the SCP accepts asynchronous operations, several C-STORE
+ * requests are sent before waiting for the responses.
+ *
+ * All the objects sent on one association must share SOP Class and
+ * Transfer Syntax, as the slices of a series do.
+ */
+class StoreSCU
+{
+public:
+/*!
+ * \param address Address of the SCP, "host:port".
+ * \param calledAET Application Entity Title of the SCP.
+ * \param callingAET Application Entity Title of this SCU.
+ * \param window Maximum number of outstanding C-STORE requests proposed.
+ * \param timeout Seconds to wait for the SCP before failing (the ARTIM and
+ *        DIMSE timeouts), 0 waits forever.
+ */
+    StoreSCU( const std::string& address, const std::string& calledAET, const std::string& callingAET, unsigned int window,
+              unsigned int timeout );
+    ~StoreSCU();
+
+    bool Open( void );
+
+/*!
+ * \brief Queue a DICOM Part 10 object for sending.
+ *
+ * The data is copied, so the buffer can be reused as soon as this returns.
+ * Blocks while too many objects are waiting to be sent.
+ *
+ * \param name Name of the object, used in messages.
+ * \return false if an error occurred while sending this or a previous object.
+ */
+    bool Store( const std::string& name, const char* data, std::size_t size );
+
+/*!
+ * \brief Wait for all the responses and release the association.
+ *
+ * \return true if all the objects were stored successfully.
+ */
+    bool Close( void );
+
+/*!
+ * \brief Check that an Application Entity Title is valid.
+ */
+    static bool IsValidAETitle( const std::string& aet );
+
+private:
+// Not implemented
+    StoreSCU(const StoreSCU&);
+    StoreSCU& operator=(const StoreSCU&);
+
+    struct Job
+    {
+        std::string name;
+        std::vector<char> data;
+    };
+
+    void Sender( void );
+    bool Send( Job* job );
+    bool Associate( const std::string& sopClass, const std::string& transferSyntax,
+                    const std::string& implementationUID, const std::string& implementationVersion );
+    bool ReceiveResponse( void );
+    bool Release( void );
+    void Abort( void );
+    bool SendPDataTF( const char* data, std::size_t size, bool command );
+    bool ReceivePDU( unsigned char& type, std::vector<char>& body );
+
+    std::string m_Host;
+    unsigned short m_Port;
+    std::string m_CalledAET;
+    std::string m_CallingAET;
+    unsigned int m_ProposedWindow;
+    unsigned int m_Timeout;
+
+    Socket m_Socket;
+    bool m_Associated;
+    std::string m_SOPClass;
+    unsigned char m_PresentationContextID;
+    std::size_t m_MaxPDV;                           //!< Maximum size of the data in each PDV sent
+    unsigned int m_Window;                          //!< Outstanding requests accepted by the SCP
+    unsigned short m_MessageID;
+    std::map<unsigned short, std::string> m_Pending; //!< Objects waiting for a response, by message ID
+    std::vector<char> m_Response;                   //!< Command fragments of the next response
+
+    std::thread m_Thread;
+    std::deque<Job*> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueNotFull;
+    std::condition_variable m_QueueNotEmpty;
+    bool m_Done;
+    bool m_Error;
+};
+//END class n2d::tools::StoreSCU
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSTORESCU_H
@@ -0,0 +1,425 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsStowClient.h"
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <cstdlib>
+#include <cctype>
+
+
+namespace n2d {
+namespace tools {
+
+namespace {
+
+const std::size_t maxheadersize = 0x10000; // Larger response headers are considered an error
+
+const char partheader[] = "\r\nContent-Type: application/dicom\r\n\r\n";
+
+
+std::string ToLower( std::string value )
+{
+    for (std::string::size_type i = 0; i < value.size(); ++i)
+        value[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(value[i])));
+    return value;
+}
+
+
+// A boundary that is very unlikely to appear in the encoded slices
+std::string NewBoundary( void )
+{
+    std::random_device random;
+    std::ostringstream boundary;
+    boundary << "nifti2dicom-" << std::hex << random() << random() << random();
+    return boundary.str();
+}
+
+
+/*
+ * Buffered reader for the HTTP response
+ */
+class ResponseReader
+{
+public:
+    ResponseReader( Socket& socket ) : m_Socket(socket) {}
+
+    // Read until the buffer contains at least size bytes
+    bool Fill( std::size_t size )
+    {
+        char chunk[4096];
+        while (m_Buffer.size() < size)
+        {
+            const long received = m_Socket.ReceiveSome(chunk, sizeof(chunk));
+            if (received <= 0)
+                return false;
+            m_Buffer.append(chunk, static_cast<std::size_t>(received));
+        }
+        return true;
+    }
+
+    // Read a line terminated by "\r\n"
+    bool ReadLine( std::string& line )
+    {
+        std::string::size_type end;
+        while ((end = m_Buffer.find("\r\n")) == std::string::npos)
+            if (m_Buffer.size() > maxheadersize || !Fill(m_Buffer.size() + 1))
+                return false;
+        line = m_Buffer.substr(0, end);
+        m_Buffer.erase(0, end + 2);
+        return true;
+    }
+
+    // Read and discard size bytes
+    bool Skip( std::size_t size )
+    {
+        while (size > 0)
+        {
+            if (m_Buffer.empty() && !Fill(1))
+                return false;
+            const std::size_t chunk = size < m_Buffer.size() ? size : m_Buffer.size();
+            m_Buffer.erase(0, chunk);
+            size -= chunk;
+        }
+        return true;
+    }
+
+    // Read and discard everything until the connection is closed
+    void SkipAll( void )
+    {
+        while (Fill(m_Buffer.size() + 1))
+            m_Buffer.clear();
+    }
+
+private:
+    Socket& m_Socket;
+    std::string m_Buffer;
+};
+
+} // namespace
+
+
+
+StowClient::StowClient( const std::string& url, unsigned int batchSize, unsigned int connections, unsigned int timeout ) :
+        m_URL(url),
+        m_Port(0),
+        m_BatchSize(batchSize > 0 ? batchSize : 1),
+        m_Connections(connections > 0 ? connections : 1),
+        m_Timeout(timeout),
+        m_Batch(NULL),
+        m_Done(false),
+        m_Error(false)
+{
+    ParseURL(url, m_Host, m_Port, m_Path);
+}
+
+
+
+StowClient::~StowClient()
+{
+    if (!m_Threads.empty())
+        Close();
+    DeleteBatch(m_Batch);
+}
+
+
+
+bool StowClient::ParseURL( const std::string& url, std::string& host, unsigned short& port, std::string& path )
+{
+    const std::string scheme("http://");
+    if (ToLower(url.substr(0, scheme.size())) != scheme)
+        return false;
+
+    const std::string::size_type slash = url.find('/', scheme.size());
+    const std::string authority = url.substr(scheme.size(), slash == std::string::npos ? std::string::npos : slash - scheme.size());
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+
+    // The port is optional, unlike in the addresses of Socket::ParseAddress()
+    const std::string::size_type bracket = authority.rfind(']');
+    const std::string::size_type colon = authority.rfind(':');
+    if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket))
+        return Socket::ParseAddress(authority + ":80", host, port);
+    return Socket::ParseAddress(authority, host, port);
+}
+
+
+
+bool StowClient::Open( void )
+{
+    if (m_Host.empty())
+    {
+        std::cerr << "ERROR: Invalid STOW-RS URL \"" << m_URL << "\"." << std::endl;
+        return false;
+    }
+    m_Done = false;
+    m_Error = false;
+    for (unsigned int i = 0; i < m_Connections; ++i)
+        m_Threads.push_back(std::thread(&StowClient::Worker, this));
+    return true;
+}
+
+
+
+bool StowClient::Store( const std::string& name, const char* data, std::size_t size )
+{
+    Instance* instance = new Instance;
+    instance->name = name;
+    instance->data.assign(data, data + size);
+
+    if (!m_Batch)
+        m_Batch = new Batch;
+    m_Batch->push_back(instance);
+    if (m_Batch->size() < m_BatchSize)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return !m_Error;
+    }
+
+    Batch* batch = m_Batch;
+    m_Batch = NULL;
+    return Queue(batch);
+}
+
+
+
+bool StowClient::Close( void )
+{
+    if (m_Batch)
+    {
+        Batch* batch = m_Batch;
+        m_Batch = NULL;
+        Queue(batch);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Done = true;
+        m_QueueNotEmpty.notify_all();
+    }
+    for (std::size_t i = 0; i < m_Threads.size(); ++i)
+        m_Threads[i].join();
+    m_Threads.clear();
+    return !m_Error;
+}
+
+
+
+bool StowClient::Queue( Batch* batch )
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    // Up to one batch waiting for each connection
+    while (!m_Error && m_Queue.size() >= m_Connections)
+        m_QueueNotFull.wait(lock);
+    if (m_Error)
+    {
+        DeleteBatch(batch);
+        return false;
+    }
+    m_Queue.push_back(batch);
+    m_QueueNotEmpty.notify_one();
+    return true;
+}
+
+
+
+void StowClient::DeleteBatch( Batch* batch )
+{
+    if (!batch)
+        return;
+    for (std::size_t i = 0; i < batch->size(); ++i)
+        delete (*batch)[i];
+    delete batch;
+}
+
+
+
+void StowClient::Worker( void )
+{
+    Socket socket;
+    for (;;)
+    {
+        Batch* batch;
+        bool error;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (m_Queue.empty() && !m_Done)
+                m_QueueNotEmpty.wait(lock);
+            if (m_Queue.empty())
+                break;
+            batch = m_Queue.front();
+            m_Queue.pop_front();
+            m_QueueNotFull.notify_one();
+            error = m_Error;
+        }
+
+        // After an error the remaining batches are discarded
+        if (!error && !Post(socket, *batch))
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Error = true;
+            m_QueueNotFull.notify_all();
+        }
+        DeleteBatch(batch);
+    }
+}
+
+
+
+bool StowClient::Post( Socket& socket, const Batch& batch )
+{
+    int status = 0;
+    std::string reason;
+    // A reused connection may have been closed by the server in the
+    // meantime, in that case the request is sent again on a new one.
+    const bool reused = socket.IsConnected();
+    if (!Send(socket, batch, status, reason))
+    {
+        socket.Close();
+        if (!reused || !Send(socket, batch, status, reason))
+        {
+            socket.Close();
+            std::cerr << "ERROR: Cannot send \"" << batch.front()->name << "\" to \"" << batch.back()->name
+                      << "\" to " << m_URL << "." << std::endl;
+            return false;
+        }
+    }
+
+    // 202 Accepted: some instances were stored with warnings, or failed
+    if (status == 202)
+        std::cerr << "WARNING: " << m_URL << " accepted \"" << batch.front()->name << "\" to \"" << batch.back()->name
+                  << "\" with warnings or failures: " << status << " " << reason << std::endl;
+    else if (status < 200 || status > 299)
+    {
+        std::cerr << "ERROR: " << m_URL << " cannot store \"" << batch.front()->name << "\" to \"" << batch.back()->name
+                  << "\": " << status << " " << reason << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+
+bool StowClient::Send( Socket& socket, const Batch& batch, int& status, std::string& reason )
+{
+    if (!socket.IsConnected() && !socket.Connect(m_Host, m_Port, m_Timeout))
+        return false;
+
+    // The parts are written directly from the encoded objects
+    const std::string boundary = NewBoundary();
+    std::size_t contentLength = boundary.size() + 6; // "--boundary--\r\n"
+    for (std::size_t i = 0; i < batch.size(); ++i)
+        contentLength += 2 + boundary.size() + sizeof(partheader) - 1 + batch[i]->data.size() + 2;
+
+    std::ostringstream request;
+    request << "POST " << m_Path << " HTTP/1.1\r\n"
+            << "Host: " << (m_Host.find(':') == std::string::npos ? m_Host : "[" + m_Host + "]") << ":" << m_Port << "\r\n"
+            << "Content-Type: multipart/related; type=\"application/dicom\"; boundary=" << boundary << "\r\n"
+            << "Content-Length: " << contentLength << "\r\n"
+            << "Accept: application/dicom+json\r\n"
+            << "\r\n";
+
+    std::string separator = request.str();
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        separator += "--" + boundary + partheader;
+        if (!socket.Send(separator.data(), separator.size()) ||
+            !socket.Send(batch[i]->data.empty() ? NULL : &batch[i]->data[0], batch[i]->data.size()))
+            return false;
+        separator = "\r\n";
+    }
+    separator += "--" + boundary + "--\r\n";
+    if (!socket.Send(separator.data(), separator.size()))
+        return false;
+
+    // Response
+    ResponseReader reader(socket);
+    std::string line;
+    bool keepAlive, chunked;
+    long long contentLengthIn;
+    do
+    {
+        if (!reader.ReadLine(line) || line.compare(0, 5, "HTTP/") != 0)
+            return false;
+        std::istringstream statusLine(line);
+        std::string version;
+        statusLine >> version >> status;
+        std::getline(statusLine >> std::ws, reason);
+        keepAlive = (version != "HTTP/1.0");
+        chunked = false;
+        contentLengthIn = -1;
+
+        while (reader.ReadLine(line) && !line.empty())
+        {
+            const std::string::size_type colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            const std::string name = ToLower(line.substr(0, colon));
+            const std::string value = ToLower(line.substr(line.find_first_not_of(' ', colon + 1) == std::string::npos ?
+                                                              line.size() : line.find_first_not_of(' ', colon + 1)));
+            if (name == "content-length")
+                contentLengthIn = std::strtoll(value.c_str(), NULL, 10);
+            else if (name == "transfer-encoding")
+                chunked = (value.find("chunked") != std::string::npos);
+            else if (name == "connection")
+                keepAlive = (value.find("close") == std::string::npos);
+        }
+        if (!line.empty())
+            return false;
+    } while (status >= 100 && status < 200); // Interim responses
+
+    // The body is not needed, but it must be read to reuse the connection.
+    // 1xx, 204 and 304 responses have no body (RFC 7230, section 3.3.3),
+    // whatever their headers say.
+    const bool body = status >= 200 && status != 204 && status != 304;
+    if (body && chunked)
+    {
+        for (;;)
+        {
+            if (!reader.ReadLine(line))
+                return false;
+            const unsigned long long size = std::strtoull(line.c_str(), NULL, 16);
+            if (size == 0)
+                break;
+            if (!reader.Skip(static_cast<std::size_t>(size)) || !reader.ReadLine(line))
+                return false;
+        }
+        while (reader.ReadLine(line) && !line.empty()) // Trailers
+            ;
+    }
+    else if (body && contentLengthIn >= 0)
+    {
+        if (!reader.Skip(static_cast<std::size_t>(contentLengthIn)))
+            return false;
+    }
+    else if (body)
+    {
+        reader.SkipAll();
+        keepAlive = false;
+    }
+
+    if (!keepAlive)
+        socket.Close();
+    return true;
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,130 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSTOWCLIENT_H
+#define N2DTOOLSSTOWCLIENT_H
+
+#include "n2dToolsSocket.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::StowClient
+/*!
+ * \brief Sends DICOM Part 10 objects to a DICOMweb STOW-RS endpoint
+ *
+ * Objects queued by Store() are grouped in batches, each batch is posted
+ * as one multipart/related request. The requests are sent by a pool of
+ * threads, each one reusing its own HTTP/1.1 connection, so that several
+ * batches are in flight while the next objects are encoded.
+ *
+ * Only plain HTTP is supported.
+ */
+class StowClient
+{
+public:
+/*!
+ * \param url STOW-RS endpoint, e.g. "http://host:8080/dicom-web/studies".
+ * \param batchSize Number of objects in each request.
+ * \param connections Number of requests sent in parallel.
+ * \param timeout Seconds to wait for the server before failing, 0 waits
+ *        forever.
+ */
+    StowClient( const std::string& url, unsigned int batchSize, unsigned int connections, unsigned int timeout );
+    ~StowClient();
+
+    bool Open( void );
+
+/*!
+ * \brief Queue a DICOM Part 10 object for sending.
+ *
+ * The data is copied, so the buffer can be reused as soon as this returns.
+ * Blocks while too many batches are waiting to be sent.
+ *
+ * \param name Name of the object, used in messages.
+ * \return false if an error occurred while sending this or a previous batch.
+ */
+    bool Store( const std::string& name, const char* data, std::size_t size );
+
+/*!
+ * \brief Send the last batch and wait for all the requests to complete.
+ *
+ * \return true if all the objects were stored successfully.
+ */
+    bool Close( void );
+
+/*!
+ * \brief Split an "http://host[:port]/path" URL.
+ *
+ * \return false if the URL is not valid or does not use http.
+ */
+    static bool ParseURL( const std::string& url, std::string& host, unsigned short& port, std::string& path );
+
+private:
+// Not implemented
+    StowClient(const StowClient&);
+    StowClient& operator=(const StowClient&);
+
+    struct Instance
+    {
+        std::string name;
+        std::vector<char> data;
+    };
+
+    typedef std::vector<Instance*> Batch;
+
+    void Worker( void );
+    bool Post( Socket& socket, const Batch& batch );
+    bool Send( Socket& socket, const Batch& batch, int& status, std::string& reason );
+    bool Queue( Batch* batch );
+    static void DeleteBatch( Batch* batch );
+
+    std::string m_URL;
+    std::string m_Host;
+    unsigned short m_Port;
+    std::string m_Path;
+    unsigned int m_BatchSize;
+    unsigned int m_Connections;
+    unsigned int m_Timeout;
+
+    Batch* m_Batch; //!< Batch being filled by Store()
+
+    std::vector<std::thread> m_Threads;
+    std::deque<Batch*> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueNotFull;
+    std::condition_variable m_QueueNotEmpty;
+    bool m_Done;
+    bool m_Error;
+};
+//END class n2d::tools::StowClient
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSTOWCLIENT_H
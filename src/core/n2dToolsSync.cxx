@@ -0,0 +1,132 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsSync.h"
+#include "Nifti2DicomConfig.h"
+
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+
+#ifndef _WIN32
+ #include <unistd.h>
+#else
+ #include <io.h>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+bool SyncFileDescriptor( int fd )
+{
+#ifndef _WIN32
+    return fsync(fd) == 0;
+#else
+    return _commit(fd) == 0;
+#endif
+}
+
+
+
+bool SyncFile( const std::string& fileName )
+{
+#ifndef _WIN32
+    // Works for directories too
+    int fd = open(fileName.c_str(), O_RDONLY);
+#else
+    // _commit requires a file opened for writing
+    int fd = _open(fileName.c_str(), _O_RDWR | _O_BINARY);
+#endif
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: Cannot open \"" << fileName << "\": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool ret = SyncFileDescriptor(fd);
+    if (!ret)
+        std::cerr << "ERROR: Cannot sync \"" << fileName << "\": " << std::strerror(errno) << std::endl;
+#ifndef _WIN32
+    close(fd);
+#else
+    _close(fd);
+#endif
+    return ret;
+}
+
+
+
+bool SyncDirectory( const std::string& directory )
+{
+#ifndef _WIN32
+    return SyncFile(directory);
+#else
+    // Directories cannot be flushed on Windows
+    (void)directory;
+    return true;
+#endif
+}
+
+
+
+bool SyncFiles( const std::string& directory, const std::vector<std::string>& fileNames, const std::vector<std::string>& directories )
+{
+#ifndef _WIN32
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "ERROR: Cannot open \"" << directory << "\": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool ret = true;
+ #ifdef N2D_HAVE_SYNCFS
+    if (syncfs(fd) != 0)
+ #endif
+    {
+        for (std::size_t i = 0; i < fileNames.size(); ++i)
+            ret = SyncFile(fileNames[i]) && ret;
+        // Make the new directory entries durable too
+        for (std::size_t i = 0; i < directories.size(); ++i)
+            if (directories[i] != directory)
+                ret = SyncFile(directories[i]) && ret;
+        if (fsync(fd) != 0)
+        {
+            std::cerr << "ERROR: Cannot sync \"" << directory << "\": " << std::strerror(errno) << std::endl;
+            ret = false;
+        }
+    }
+    close(fd);
+    return ret;
+#else
+    // Directories cannot be flushed on Windows
+    (void)directory;
+    (void)directories;
+    bool ret = true;
+    for (std::size_t i = 0; i < fileNames.size(); ++i)
+        ret = SyncFile(fileNames[i]) && ret;
+    return ret;
+#endif
+}
+
+} // namespace tools
+} // namespace n2d
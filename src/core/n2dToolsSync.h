@@ -0,0 +1,70 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSSYNC_H
+#define N2DTOOLSSYNC_H
+
+#include <string>
+#include <vector>
+
+namespace n2d {
+namespace tools {
+
+/*!
+ * \brief Flush an open file descriptor to stable storage.
+ *
+ * \return true on success.
+ */
+bool SyncFileDescriptor( int fd );
+
+/*!
+ * \brief Flush a file to stable storage.
+ *
+ * \return true on success.
+ */
+bool SyncFile( const std::string& fileName );
+
+/*!
+ * \brief Flush a directory, so that the entries of the files created in it
+ * are on stable storage.
+ *
+ * Does nothing where directories cannot be flushed (Windows).
+ *
+ * \return true on success.
+ */
+bool SyncDirectory( const std::string& directory );
+
+/*!
+ * \brief Flush a set of files written in a directory, and the directory.
+ *
+ * Where available, a single syncfs() on the file system containing the
+ * directory is used, otherwise every file, then every directory in
+ * \c directories (those whose entries changed, e.g. the directories
+ * containing the files and the parents of the directories created for
+ * them) and finally \c directory are flushed one by one.
+ *
+ * \return true on success.
+ */
+bool SyncFiles( const std::string& directory, const std::vector<std::string>& fileNames, const std::vector<std::string>& directories );
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSSYNC_H
@@ -0,0 +1,287 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#include "n2dToolsTar.h"
+#include "Nifti2DicomConfig.h"
+#include "n2dToolsSync.h"
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#ifdef N2D_HAVE_ZSTD
+ #include <zstd.h>
+#endif
+
+#ifdef _WIN32
+ #include <io.h>
+ #include <fcntl.h>
+#endif
+
+
+namespace n2d {
+namespace tools {
+
+const std::size_t tarblocksize = 512;
+
+
+TarWriter::TarWriter() :
+        m_File(NULL),
+        m_OwnsFile(false),
+        m_CStream(NULL)
+{
+}
+
+
+
+TarWriter::~TarWriter()
+{
+    if (m_File)
+        Close();
+}
+
+
+
+bool TarWriter::CanCompress( void )
+{
+#ifdef N2D_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+
+bool TarWriter::Open( const std::string& fileName, bool compress )
+{
+    if (compress && !CanCompress())
+    {
+        std::cerr << "ERROR: nifti2dicom was built without zstd support." << std::endl;
+        return false;
+    }
+
+    m_File = std::fopen(fileName.c_str(), "wb");
+    if (!m_File)
+    {
+        std::cerr << "ERROR: Cannot open \"" << fileName << "\" for writing." << std::endl;
+        return false;
+    }
+    m_OwnsFile = true;
+
+    return InitCompression(compress);
+}
+
+
+
+bool TarWriter::Open( std::FILE* file, bool compress )
+{
+    if (compress && !CanCompress())
+    {
+        std::cerr << "ERROR: nifti2dicom was built without zstd support." << std::endl;
+        return false;
+    }
+
+    m_File = file;
+    m_OwnsFile = false;
+
+    return m_File && InitCompression(compress);
+}
+
+
+
+bool TarWriter::InitCompression( bool compress )
+{
+#ifdef N2D_HAVE_ZSTD
+    if (compress)
+    {
+        ZSTD_CStream* cstream = ZSTD_createCStream();
+        if (!cstream || ZSTD_isError(ZSTD_initCStream(cstream, ZSTD_CLEVEL_DEFAULT)))
+        {
+            std::cerr << "ERROR: Cannot initialize zstd compression." << std::endl;
+            ZSTD_freeCStream(cstream);
+            return false;
+        }
+        m_CStream = cstream;
+    }
+#else
+    (void)compress;
+#endif
+
+    return true;
+}
+
+
+
+bool TarWriter::AddFile( const std::string& name, const char* data, std::size_t size )
+{
+    char header[tarblocksize];
+    std::memset(header, 0, tarblocksize);
+
+    // Names longer than 100 characters are split between "prefix" and "name"
+    std::string fileName(name);
+    std::string prefix;
+    if (fileName.size() > 100)
+    {
+        std::string::size_type slash = fileName.rfind('/', 155);
+        if (slash == std::string::npos || fileName.size() - slash - 1 > 100)
+        {
+            std::cerr << "ERROR: File name \"" << name << "\" is too long for the archive." << std::endl;
+            return false;
+        }
+        prefix = fileName.substr(0, slash);
+        fileName = fileName.substr(slash + 1);
+    }
+
+    std::memcpy(header, fileName.data(), fileName.size());                  // name
+    std::snprintf(header + 100, 8, "%07o", 0644);                           // mode
+    std::snprintf(header + 108, 8, "%07o", 0);                              // uid
+    std::snprintf(header + 116, 8, "%07o", 0);                              // gid
+    std::snprintf(header + 124, 12, "%011llo", static_cast<unsigned long long>(size)); // size
+    std::snprintf(header + 136, 12, "%011llo", static_cast<unsigned long long>(std::time(NULL))); // mtime
+    std::memset(header + 148, ' ', 8);                                      // chksum (placeholder)
+    header[156] = '0';                                                      // typeflag: regular file
+    std::memcpy(header + 257, "ustar", 6);                                  // magic
+    std::memcpy(header + 263, "00", 2);                                     // version
+    std::memcpy(header + 345, prefix.data(), prefix.size());                // prefix
+
+    unsigned int checksum = 0;
+    for (std::size_t i = 0; i < tarblocksize; ++i)
+        checksum += static_cast<unsigned char>(header[i]);
+    std::snprintf(header + 148, 8, "%06o", checksum);
+    header[155] = ' ';
+
+    if (!Write(header, tarblocksize) || !Write(data, size))
+        return false;
+
+    const std::size_t padding = (tarblocksize - size % tarblocksize) % tarblocksize;
+    if (padding)
+    {
+        char zeros[tarblocksize];
+        std::memset(zeros, 0, tarblocksize);
+        if (!Write(zeros, padding))
+            return false;
+    }
+    return true;
+}
+
+
+
+bool TarWriter::Close( void )
+{
+    if (!m_File)
+        return false;
+
+    // End of archive: two empty blocks
+    char zeros[2 * tarblocksize];
+    std::memset(zeros, 0, 2 * tarblocksize);
+    bool ret = Write(zeros, 2 * tarblocksize) && FlushStream(true);
+
+#ifdef N2D_HAVE_ZSTD
+    ZSTD_freeCStream(static_cast<ZSTD_CStream*>(m_CStream));
+    m_CStream = NULL;
+#endif
+
+    if (m_OwnsFile && std::fclose(m_File) != 0)
+        ret = false;
+    m_File = NULL;
+    return ret;
+}
+
+
+
+bool TarWriter::Flush( void )
+{
+    return m_File && FlushStream(false);
+}
+
+
+
+bool TarWriter::Sync( void )
+{
+#ifndef _WIN32
+    return Flush() && SyncFileDescriptor(fileno(m_File));
+#else
+    return Flush() && SyncFileDescriptor(_fileno(m_File));
+#endif
+}
+
+
+
+bool TarWriter::Write( const char* data, std::size_t size )
+{
+    if (!m_CStream)
+        return std::fwrite(data, 1, size, m_File) == size;
+
+#ifdef N2D_HAVE_ZSTD
+    ZSTD_CStream* cstream = static_cast<ZSTD_CStream*>(m_CStream);
+    ZSTD_inBuffer input = { data, size, 0 };
+    m_Buffer.resize(ZSTD_CStreamOutSize());
+    while (input.pos < input.size)
+    {
+        ZSTD_outBuffer output = { &m_Buffer[0], m_Buffer.size(), 0 };
+        if (ZSTD_isError(ZSTD_compressStream(cstream, &output, &input)))
+            return false;
+        if (std::fwrite(output.dst, 1, output.pos, m_File) != output.pos)
+            return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+
+bool TarWriter::FlushStream( bool end )
+{
+    if (!m_CStream)
+        return std::fflush(m_File) == 0;
+
+#ifdef N2D_HAVE_ZSTD
+    ZSTD_CStream* cstream = static_cast<ZSTD_CStream*>(m_CStream);
+    m_Buffer.resize(ZSTD_CStreamOutSize());
+    std::size_t remaining;
+    do
+    {
+        ZSTD_outBuffer output = { &m_Buffer[0], m_Buffer.size(), 0 };
+        remaining = end ? ZSTD_endStream(cstream, &output) : ZSTD_flushStream(cstream, &output);
+        if (ZSTD_isError(remaining))
+            return false;
+        if (std::fwrite(output.dst, 1, output.pos, m_File) != output.pos)
+            return false;
+    } while (remaining != 0);
+    return std::fflush(m_File) == 0;
+#else
+    (void)end;
+    return false;
+#endif
+}
+
+std::FILE* StandardOutput()
+{
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    return stdout;
+}
+
+} // namespace tools
+} // namespace n2d
@@ -0,0 +1,120 @@
+//  This file is part of Nifti2Dicom, is an open source converter from
+//  3D NIfTI images to 2D DICOM series.
+//
+//  Copyright (C) 2008, 2009, 2010 Daniele E. Domenichelli <ddomenichelli@drdanz.it>
+//
+//  Nifti2Dicom is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Nifti2Dicom is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Nifti2Dicom.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef N2DTOOLSTAR_H
+#define N2DTOOLSTAR_H
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+namespace n2d {
+namespace tools {
+
+//BEGIN class n2d::tools::TarWriter
+/*!
+ * \brief Writes a sequential (ustar) tar archive
+ *
+ * Members are appended one after the other and are never seeked back to,
+ * so the archive can be written to a pipe or to storage that does not like
+ * random access. If Nifti2Dicom was built with zstd support, the archive
+ * can be compressed on the fly.
+ */
+class TarWriter
+{
+public:
+    TarWriter();
+    ~TarWriter();
+
+/*!
+ * \brief Open a new archive.
+ *
+ * \param fileName Archive file name.
+ * \param compress Compress the archive using zstd.
+ * \return true on success.
+ */
+    bool Open( const std::string& fileName, bool compress );
+
+/*!
+ * \brief Start a new archive on an already open file (e.g. the standard output).
+ *
+ * The file is not closed by Close().
+ */
+    bool Open( std::FILE* file, bool compress );
+
+/*!
+ * \brief Append a regular file to the archive.
+ *
+ * \return true on success.
+ */
+    bool AddFile( const std::string& name, const char* data, std::size_t size );
+
+/*!
+ * \brief Flush the data written so far, so that the reader can process it.
+ *
+ * \return true on success.
+ */
+    bool Flush( void );
+
+/*!
+ * \brief Flush the data written so far to stable storage.
+ *
+ * \return true on success.
+ */
+    bool Sync( void );
+
+/*!
+ * \brief Write the end of archive marker and close the archive.
+ *
+ * \return true on success.
+ */
+    bool Close( void );
+
+/*!
+ * \brief Whether zstd compression is available.
+ */
+    static bool CanCompress( void );
+
+private:
+// Not implemented
+    TarWriter(const TarWriter&);
+    TarWriter& operator=(const TarWriter&);
+
+    bool InitCompression( bool compress );
+    bool Write( const char* data, std::size_t size );
+    bool FlushStream( bool end );
+
+    std::FILE* m_File;
+    bool m_OwnsFile;
+    void* m_CStream; //!< ZSTD_CStream, when compressing
+    std::string m_Buffer; //!< Compressed data waiting to be written
+};
+//END class n2d::tools::TarWriter
+
+
+/*!
+ * \brief Get the standard output, set up for binary data.
+ */
+std::FILE* StandardOutput();
+
+} // namespace tools
+} // namespace n2d
+
+#endif // N2DTOOLSTAR_H
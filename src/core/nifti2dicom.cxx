@@ -57,14 +57,19 @@ More notes:
     6. Study
     7. Series
     8. Acquisition
+       (with --slab, steps 9 to 12 are repeated for each slab of slices)
     9. Image import
    10. Image filters
    11. Instance (Reslicing)
-   12. Output
+   12. Output (color images are written by n2d::ColorExporter)
+       (or, for a label map, a single Segmentation after the image filters)
 */
 
 
 #include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 #include "n2dDefsImage.h"
 #include "n2dDefsMetadata.h"
@@ -84,8 +89,12 @@ More notes:
 #include "n2dInputFilter.h"
 #include "n2dInstance.h"
 #include "n2dOutputExporter.h"
+#include "n2dSegmentationExporter.h"
+#include "n2dColorExporter.h"
+#include "n2dProbe.h"
 
 #include "n2dToolsMetaDataDictionary.h"
+#include "n2dToolsSliceHeaderIndex.h"
 
 
 int main(int argc, char* argv[])
@@ -95,8 +104,11 @@ int main(int argc, char* argv[])
     n2d::CommandLineParser parser;
     n2d::ImageType::ConstPointer inputImage;
     n2d::PixelType inputPixelType;
-    n2d::DICOM3DImageType::ConstPointer filteredImage;
+    n2d::ImageType::ConstPointer filteredImage;
+    n2d::PixelType outputPixelType;
+    std::vector<double> sliceMinimum, sliceMaximum;
     n2d::DictionaryType dictionary, importedDictionary;
+    n2d::tools::SliceHeaderIndex referenceSliceHeaders;
     n2d::DictionaryArrayType dictionaryArray;
 
     n2d::DICOMImageIOType::Pointer dicomIO = n2d::DICOMImageIOType::New();
@@ -120,10 +132,50 @@ int main(int argc, char* argv[])
         std::cerr << "ERROR in \"Command line parsing\"." << std::endl;
         exit(101);
     }
+
+    // When the series is streamed on the standard output, all the messages
+    // are sent to the standard error instead. The plan of a probe is
+    // always written on the standard output.
+    if (parser.outputArgs.outputdirectory == "-" && !parser.outputArgs.probe)
+        std::cout.rdbuf(std::cerr.rdbuf());
 //END Command line parsing
 
 
 
+//BEGIN Probe
+    // Only the plan of the conversion is written
+    if (parser.outputArgs.probe)
+    {
+        try
+        {
+            n2d::Probe probe(parser.inputArgs, parser.filtersArgs, parser.outputArgs);
+            if (!probe.Run(std::cout))
+            {
+                std::cerr << "ERROR in \"Probe\"." << std::endl;
+                exit(14);
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "Unknown ERROR in \"Probe\"." << std::endl;
+            exit(114);
+        }
+        return EXIT_SUCCESS;
+    }
+//END Probe
+
+
+
+//BEGIN Previous conversion
+    // Reuse UIDs, dates and times of the previous conversion, so that only
+    // the slices that changed have to be written again.
+    if ((parser.outputArgs.incremental || parser.outputArgs.resume) &&
+        n2d::OutputExporter::LoadPreviousTags(parser.outputArgs, dictionary))
+        std::cout << " * \033[1;34mPrevious conversion found\033[0m" << std::endl;
+//END Previous conversion
+
+
+
 
 //BEGIN DICOM accession number validation
     try
@@ -147,7 +199,7 @@ int main(int argc, char* argv[])
 //BEGIN DICOM header import
     try
     {
-        n2d::HeaderImporter headerImporter(parser.dicomHeaderArgs, importedDictionary);
+        n2d::HeaderImporter headerImporter(parser.dicomHeaderArgs, importedDictionary, referenceSliceHeaders);
         if (!headerImporter.Import())
         {
             std::cerr << "ERROR in \"DICOM header import\"." << std::endl;
@@ -278,88 +330,207 @@ int main(int argc, char* argv[])
 
 
 
-//BEGIN Input image import
-    try
+//BEGIN Slabs
+    // With --slab the slices are converted a slab at a time: each slab is
+    // read, filtered and written before the next one is read.
+    std::vector< std::pair<unsigned long long, unsigned long long> > slabs;
+    if (parser.inputArgs.slab > 0)
     {
-        n2d::InputImporter inputImporter(parser.inputArgs);
-        if (!inputImporter.Import())
+        try
         {
-            std::cerr << "ERROR in \"Input image import\"." << std::endl;
-            exit(10);
+            n2d::InputImporter inputImporter(parser.inputArgs);
+            if (!inputImporter.ReadImageInformation())
+            {
+                std::cerr << "ERROR in \"Slabs\"." << std::endl;
+                exit(16);
+            }
+            if (!inputImporter.canReadSliceRange())
+            {
+                std::cerr << "ERROR: Color images with components wider than 8 bits are scaled on the whole volume, they cannot be converted in slabs." << std::endl;
+                std::cerr << "ERROR in \"Slabs\"." << std::endl;
+                exit(16);
+            }
+            // Otherwise each slab would read (and e.g. inflate) the whole volume
+            if (!inputImporter.getImageIO()->CanStreamRead())
+            {
+                std::cerr << "ERROR: The slices of \"" << parser.inputArgs.inputfile << "\" cannot be read on their own (e.g. compressed file), they cannot be converted in slabs." << std::endl;
+                std::cerr << "ERROR in \"Slabs\"." << std::endl;
+                exit(16);
+            }
+            const unsigned long long nbSlices = inputImporter.getImageIO()->GetDimensions(2);
+            const unsigned long long first = parser.inputArgs.slicestart;
+            const unsigned long long last = (parser.inputArgs.sliceend == 0 || parser.inputArgs.sliceend > nbSlices) ? nbSlices : parser.inputArgs.sliceend;
+            for (unsigned long long start = first; start < last; start += parser.inputArgs.slab)
+            {
+                const unsigned long long end = std::min<unsigned long long>(start + parser.inputArgs.slab, last);
+                slabs.push_back(std::make_pair(start, end));
+            }
+            if (slabs.empty())
+            {
+                std::cerr << "ERROR: The slice range is outside the image." << std::endl;
+                std::cerr << "ERROR in \"Slabs\"." << std::endl;
+                exit(16);
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "Unknown ERROR in \"Slabs\"." << std::endl;
+            exit(116);
         }
-        inputImage = inputImporter.getImportedImage();
-        inputPixelType = inputImporter.getPixelType();
     }
-    catch (...)
+    else
     {
-        std::cerr << "Unknown ERROR in \"Input image import\"." << std::endl;
-        exit(110);
+        slabs.push_back(std::make_pair(parser.inputArgs.slicestart, parser.inputArgs.sliceend));
     }
-//END Input image import
+//END Slabs
 
 
 
-//BEGIN Input filtering
-    try
+    for (std::size_t slab = 0; slab < slabs.size(); slab++)
     {
-        n2d::InputFilter inputFilter(parser.filtersArgs, inputImage, inputPixelType, dictionary);
-        if (!inputFilter.Filter())
+        n2d::InputArgs inputArgs = parser.inputArgs;
+        n2d::FiltersArgs filtersArgs = parser.filtersArgs;
+        if (parser.inputArgs.slab > 0)
         {
-            std::cerr << "ERROR in \"Input filtering\"." << std::endl;
-            exit(11);
+            inputArgs.slicestart = filtersArgs.slicestart = slabs[slab].first;
+            inputArgs.sliceend = filtersArgs.sliceend = slabs[slab].second;
+            std::cout << " * \033[1;34mSlab\033[0m " << slab + 1 << " of " << slabs.size() << ": slices "
+                      << slabs[slab].first << " to " << slabs[slab].second - 1 << std::endl;
         }
-        filteredImage = inputFilter.getFilteredImage();
-    }
-    catch (...)
-    {
-        std::cerr << "Unknown ERROR in \"Input filtering\"." << std::endl;
-        exit(111);
-    }
-//END Input filtering
 
 
 
-//BEGIN Instance
-    try
-    {
-        n2d::Instance instance(parser.instanceArgs, filteredImage, dictionary, dictionaryArray);
-        if (!instance.Update())
+    //BEGIN Input image import
+        try
         {
-            std::cerr << "ERROR in \"Instance\"." << std::endl;
-            exit(12);
+            n2d::InputImporter inputImporter(inputArgs);
+            if (!inputImporter.Import())
+            {
+                std::cerr << "ERROR in \"Input image import\"." << std::endl;
+                exit(10);
+            }
+            inputImage = inputImporter.getImportedImage();
+            inputPixelType = inputImporter.getPixelType();
         }
-    }
-    catch (...)
-    {
-        std::cerr << "Unknown ERROR in \"Instance\"." << std::endl;
-        exit(112);
-    }
-//END Instance
+        catch (...)
+        {
+            std::cerr << "Unknown ERROR in \"Input image import\"." << std::endl;
+            exit(110);
+        }
+    //END Input image import
 
 
 
-//BEGIN Output
-    try
-    {
+    //BEGIN Input filtering
+        try
+        {
+            n2d::InputFilter inputFilter(filtersArgs, inputImage, inputPixelType, dictionary);
+            if (!inputFilter.Filter())
+            {
+                std::cerr << "ERROR in \"Input filtering\"." << std::endl;
+                exit(11);
+            }
+            filteredImage = inputFilter.getFilteredImage();
+            outputPixelType = inputFilter.getOutputPixelType();
+            sliceMinimum = inputFilter.getSliceMinimum();
+            sliceMaximum = inputFilter.getSliceMaximum();
+        }
+        catch (...)
+        {
+            std::cerr << "Unknown ERROR in \"Input filtering\"." << std::endl;
+            exit(111);
+        }
+    //END Input filtering
+
 
+
+    //BEGIN Segmentation
+        // A label map is written as a single Segmentation instead of a series
+        if (parser.outputArgs.segmentation)
+        {
+            try
+            {
+                n2d::SegmentationExporter segmentationExporter(parser.outputArgs, filteredImage, outputPixelType, dictionary);
+                if (!segmentationExporter.Export())
+                {
+                    std::cerr << "ERROR in \"Segmentation\"." << std::endl;
+                    exit(15);
+                }
+            }
+            catch (...)
+            {
+                std::cerr << "Unknown ERROR in \"Segmentation\"." << std::endl;
+                exit(115);
+            }
+            return EXIT_SUCCESS;
+        }
+    //END Segmentation
+
+
+
+    //BEGIN Instance
+        try
+        {
+            n2d::Instance instance(parser.instanceArgs, filteredImage, dictionary, referenceSliceHeaders, sliceMinimum, sliceMaximum, dictionaryArray);
+            if (!instance.Update())
+            {
+                std::cerr << "ERROR in \"Instance\"." << std::endl;
+                exit(12);
+            }
+        }
+        catch (...)
+        {
+            std::cerr << "Unknown ERROR in \"Instance\"." << std::endl;
+            exit(112);
+        }
+    //END Instance
+
+
+
+    //BEGIN Output
+        try
+        {
+            // RGB and RGBA images, converted to 8 bits RGB by n2d::InputFilter
+            if (filteredImage->GetNumberOfComponentsPerPixel() > 1)
+            {
+                n2d::ColorExporter colorExporter(parser.outputArgs, filteredImage, dictionaryArray);
+                if (!colorExporter.Export())
+                {
+                    std::cerr << "ERROR in \"Output\"." << std::endl;
+                    exit(13);
+                }
+            }
+            else
+            {
 #ifndef DONT_USE_ARRAY
-        n2d::OutputExporter outputExporter(parser.outputArgs, filteredImage, dictionaryArray, dicomIO);
+                n2d::OutputExporter outputExporter(parser.outputArgs, filteredImage, outputPixelType, dictionaryArray, dicomIO);
 #else // DONT_USE_ARRAY
-        n2d::OutputExporter outputExporter(parser.outputArgs, filteredImage, dictionary, dicomIO);
+                n2d::OutputExporter outputExporter(parser.outputArgs, filteredImage, outputPixelType, dictionary, dicomIO);
 #endif // DONT_USE_ARRAY
 
-        if (!outputExporter.Export())
+                if (!outputExporter.Export())
+                {
+                    std::cerr << "ERROR in \"Output\"." << std::endl;
+                    exit(13);
+                }
+            }
+        }
+        catch (...)
         {
-            std::cerr << "ERROR in \"Output\"." << std::endl;
-            exit(13);
+            std::cerr << "Unknown ERROR in \"Output\"." << std::endl;
+            exit(113);
         }
+    //END Output
+
+
+
+        // Only the next slab is kept in memory
+        for (std::size_t i = 0; i < dictionaryArray.size(); i++)
+            delete dictionaryArray[i];
+        dictionaryArray.clear();
+        inputImage = NULL;
+        filteredImage = NULL;
     }
-    catch (...)
-    {
-        std::cerr << "Unknown ERROR in \"Output\"." << std::endl;
-        exit(113);
-    }
-//END Output
 
     return EXIT_SUCCESS;
 }
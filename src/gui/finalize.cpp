@@ -188,7 +188,9 @@ bool finalize::validatePage()
 
     dicomIO->KeepOriginalUIDOn(); // Preserve the original DICOM UID of the input files
     dicomIO->UseCompressionOff();
-    n2d::DICOM3DImageType::ConstPointer filteredImage;
+    n2d::ImageType::ConstPointer filteredImage;
+    n2d::PixelType outputPixelType;
+    std::vector<double> sliceMinimum, sliceMaximum;
     n2d::FiltersArgs 					filtersArgs;
     n2d::InstanceArgs 					instanceArgs;
     n2d::OutputArgs						outputArgs;
@@ -236,6 +238,9 @@ bool finalize::validatePage()
 			return false;
         }
         filteredImage = inputFilter.getFilteredImage();
+        outputPixelType = inputFilter.getOutputPixelType();
+        sliceMinimum = inputFilter.getSliceMinimum();
+        sliceMaximum = inputFilter.getSliceMaximum();
 		tmp_progressInfo->clear();
 		tmp_progressInfo->insert("Volume ranges properly filtered");
 		tmp_progressBar->setValue(2);
@@ -251,7 +256,7 @@ bool finalize::validatePage()
 	//BEGIN Instance
     try
     {
-        n2d::Instance instance(instanceArgs, filteredImage, *m_dictionary, m_dictionaryArray);
+        n2d::Instance instance(instanceArgs, filteredImage, *m_dictionary, *m_parent->getSliceHeaders(), sliceMinimum, sliceMaximum, m_dictionaryArray);
         if (!instance.Update())
         {
             std::cerr << "ERROR in \"Instance\"." << std::endl;
@@ -275,7 +280,7 @@ bool finalize::validatePage()
     try
     {
 
-        n2d::OutputExporter outputExporter(outputArgs, filteredImage, m_dictionaryArray, dicomIO);
+        n2d::OutputExporter outputExporter(outputArgs, filteredImage, outputPixelType, m_dictionaryArray, dicomIO);
         if (!outputExporter.Export())
         {
             std::cerr << "ERROR in \"Output\"." << std::endl;
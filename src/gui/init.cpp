@@ -109,7 +109,7 @@ init::init(QWidget *parent) :
         m_dictionary(m_parent->getDictionary()),
         m_inputArgs(new n2d::InputArgs()),
         m_dicomHeaderArgs(new n2d::DicomHeaderArgs()),
-        m_headerImporter(new n2d::HeaderImporter(*m_dicomHeaderArgs, *m_importedDictionary))
+        m_headerImporter(new n2d::HeaderImporter(*m_dicomHeaderArgs, *m_importedDictionary, *m_parent->getSliceHeaders()))
 {
     this->setTitle("First Step");
     this->setSubTitle("Required input: Nifti filename and optional dicom reference header");
@@ -32,6 +32,7 @@
 
 #include <n2dDefsCommandLineArgsStructs.h>
 #include <n2dDefsMetadata.h>
+#include <n2dToolsSliceHeaderIndex.h>
 
 #include "vtkKWImage.h"
 
@@ -68,6 +69,7 @@ public:
 
     inline n2d::DictionaryType*                getImportedDictionary() { return &m_importedDictionary; }
     inline n2d::DictionaryType*                getDictionary() { return &m_dictionary; }
+    inline n2d::tools::SliceHeaderIndex*       getSliceHeaders() { return &m_sliceHeaders; }
     inline void                                setImportedImage( vtkKWImage* in) {m_importedImage = in; }
     inline n2d::PixelType                      getImportedPixelType() const { return m_importedImage->GetITKScalarPixelType(); }
     inline n2d::ImageType::ConstPointer        getImportedImage() const { return m_importedImage->GetITKImageBase(); }
@@ -121,6 +123,7 @@ private:
 //BEGIN n2dDictionaryObject
     n2d::DictionaryType         m_importedDictionary;
     n2d::DictionaryType         m_dictionary;
+    n2d::tools::SliceHeaderIndex m_sliceHeaders;
 //END n2dDictionaryObject
 
     QSignalSpy*                 m_spy;